@@ -34,6 +34,16 @@
 // === for Monochrome SPI ===
 #define DMD_USE_DMA	1
 
+/* STM32F4 only: refresh the panels by chained timers and DMA,
+  without CPU work at every row. The CPU is used only to swap the buffers.
+  Uses TIMER1, DMA2 streams 2 & 6 and DMA1 stream of the MAIN_TIMER update
+  in addition to MAIN_TIMER and OE_TIMER.
+  Requirements: SPI2 or SPI3, LAT (SCLK) and mux pins at the same GPIO port,
+  the only one SPI display in the sketch.
+  If the requirements are not met, the display uses interrupt-driven refresh.
+  */
+//#define DMD_SPI_DMA_CHAIN
+
 // === for Monochrome Parallel ===
 /* Normally, CLK pin and DATA pins for all parallel matrix rows 
  
@@ -44,4 +54,17 @@
   pins in the upper byte of the port.
   */
 //#define USE_UPPER_8BIT
+
+/* STM32 only: use the whole 16-bit GPIO port for CLK and DATA pins,
+  that allows up to 15 parallel matrix rows, output in one BSRR write per column.
+  The buffer takes twice as much memory. USE_UPPER_8BIT is ignored.
+  */
+//#define USE_16BIT_PARALLEL
+
+/* STM32F4 only: send the row data to the port by DMA, paced by TIMER1,
+  instead of the CPU loop in the scan interrupt.
+  Uses TIMER1 and DMA2 streams 1 & 6, so it can't be combined with 
+  RGB panels with RGB_DMA or with DMD_SPI_DMA_CHAIN.
+  */
+//#define PARALLEL_DMA
 #endif
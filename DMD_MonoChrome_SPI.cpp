@@ -22,26 +22,14 @@ DMD_MonoChrome_SPI::DMD_MonoChrome_SPI(byte _pin_A, byte _pin_B, byte _pin_nOE,
 	:DMD(new DMD_Pinlist(_pin_A, _pin_B), _pin_nOE, _pin_SCLK, panelsWide, panelsHigh,
 		DMD_MONO_SCAN, new DMD_Pinlist(_spi.sckPin(), _spi.mosiPin()), d_buf, dmd_pixel_x, dmd_pixel_y), SPI_DMD(_spi)
 {
-	mem_Buffer_Size = DisplaysTotal * ((DMD_PIXELS_ACROSS * DMD_BITSPERPIXEL / 8) * DMD_PIXELS_DOWN);
-	row1 = DisplaysTotal << 4;
-	row2 = DisplaysTotal << 5;
-	row3 = ((DisplaysTotal << 2) * 3) << 2;
 	rowsize = DisplaysTotal << 2;
 
 	// Allocate and initialize matrix buffer:
-	uint16_t allocsize = (dbuf == true) ? (mem_Buffer_Size * 2) : mem_Buffer_Size;
-	matrixbuff[0] = (uint8_t*)malloc(allocsize);
+	uint16_t allocsize = (dbuf == true) ? (frame_size() * 2) : frame_size();
+	set_matrix((uint8_t*)malloc(allocsize), frame_size(), dbuf);
+	fast_Hbyte = true;
 
-	// If not double-buffered, both buffers then point to the same address:
-	matrixbuff[1] = (dbuf == true) ? &matrixbuff[0][mem_Buffer_Size] : matrixbuff[0];
-	backindex = 0;
-	bDMDScreenRAM = matrixbuff[backindex]; // Back buffer
-	front_buff = matrixbuff[1 - backindex]; // -> front buffer
 
-
-#if ( DMD_USE_DMA )	
-	dmd_dma_buf = (byte*)malloc(mem_Buffer_Size / DMD_MONO_SCAN);
-#endif
 #if defined(__STM32F1__) 
 	spiDmaDev = DMA1;
 	if (SPI_DMD.dev() == SPI1) {
@@ -80,11 +68,24 @@ DMD_MonoChrome_SPI::DMD_MonoChrome_SPI(byte _pin_A, byte _pin_B, byte _pin_nOE,
 DMD_MonoChrome_SPI::~DMD_MonoChrome_SPI()
 {
 	free(matrixbuff[0]);
-#if ( DMD_USE_DMA )	
-	free(dmd_dma_buf);
+	if (own_cells) free(tile_cells);
+#if defined(DMD_SPI_DMA_CHAIN)
+	free(chain_mux_latch);
 #endif
 }
 /*--------------------------------------------------------------------------------------*/
+void DMD_MonoChrome_SPI::set_matrix(uint8_t* buff, uint16_t size, bool double_buf) {
+
+	mem_Buffer_Size = size;
+	matrixbuff[0] = buff;
+	// If not double-buffered, both buffers then point to the same address:
+	matrixbuff[1] = double_buf ? &buff[size] : buff;
+	backindex = 0;
+	swapflag = false;
+	bDMDScreenRAM = matrixbuff[backindex]; // Back buffer
+	front_buff = matrixbuff[1 - backindex]; // -> front buffer
+}
+/*--------------------------------------------------------------------------------------*/
 void DMD_MonoChrome_SPI::set_pin_modes() {
 
 	DMD::set_pin_modes();
@@ -105,6 +106,9 @@ void DMD_MonoChrome_SPI::init(uint16_t scan_interval) {
 	SPI_DMD.setDataMode(SPI_MODE0); //Set the  SPI data mode 0
 	//SPI_DMD.setClockDivider(SPI_CLOCK_DIV16);  // Use a different speed to SPI 1 */
 	SPI_DMD.beginTransaction(SPISettings(DMD_SPI_CLOCK, MSBFIRST, SPI_MODE0));
+#if defined(DMD_SPI_DMA_CHAIN)
+	if (startDMAChain()) return;
+#endif
 	register_running_dmd(this, scan_interval);
 
 #elif  (defined(ARDUINO_ARCH_RP2040))
@@ -122,7 +126,7 @@ void DMD_MonoChrome_SPI::drawPixel(int16_t x, int16_t y, uint16_t color)
 	if (bX >= (_width) || bY >= (_height)) {
 		return;
 	}
-	if (bX < 0 || bY < 0) {
+	if (bX < 0 || bY < 0 || tile_cells) {
 		return;
 	}
 	// transform X & Y for Rotate and connect scheme
@@ -130,53 +134,172 @@ void DMD_MonoChrome_SPI::drawPixel(int16_t x, int16_t y, uint16_t color)
 	// inverse data bits for some panels
 	bPixel = bPixel ^ inverse_ALL_flag;
 
-	//byte panel = (bX / DMD_PIXELS_ACROSS) + (DisplaysWide*(bY / DMD_PIXELS_DOWN));
-	bX += (this->WIDTH * (bY / DMD_PIXELS_DOWN));
-	bY = bY % DMD_PIXELS_DOWN;
 	//set pointer to DMD RAM byte to be modified
-	uiDMDRAMPointer = bX / 8 + bY * (DisplaysTotal << 2);
+	uiDMDRAMPointer = line_offset(bY) + (bX / 8) * DMD_MONO_SCAN;
 
 	byte lookup = bPixelLookupTable[bX & 0x07];
-	/*if (bPixel == true)
-		bDMDScreenRAM[uiDMDRAMPointer] &= ~lookup;	// zero bit is pixel on
-	else
-		bDMDScreenRAM[uiDMDRAMPointer] |= lookup;	// one bit is pixel off
-	*/
-	switch (graph_mode) {
-	case GRAPHICS_NORMAL:
-		if (bPixel == true)
-			bDMDScreenRAM[uiDMDRAMPointer] &= ~lookup;	// zero bit is pixel on
-		else
-			bDMDScreenRAM[uiDMDRAMPointer] |= lookup;	// one bit is pixel off
-		break;
-		/*case GRAPHICS_INVERSE:
-			if (bPixel == false)
-				bDMDScreenRAM[uiDMDRAMPointer] &= ~lookup;	// zero bit is pixel on
-			else
-				bDMDScreenRAM[uiDMDRAMPointer] |= lookup;	// one bit is pixel off
-			break;
-		case GRAPHICS_TOGGLE:
-			if (bPixel == true) {
-			if ((bDMDScreenRAM[uiDMDRAMPointer] & lookup) == 0)
-				bDMDScreenRAM[uiDMDRAMPointer] |= lookup;	// one bit is pixel off
-			else
-				bDMDScreenRAM[uiDMDRAMPointer] &= ~lookup;	// one bit is pixel off
+	DMD_RasterOp rop = get_raster_op(graph_mode);
+	// zero bit is pixel on
+	bDMDScreenRAM[uiDMDRAMPointer] = ~rop.apply((uint8_t)~bDMDScreenRAM[uiDMDRAMPointer], (bPixel == true) ? lookup : 0, lookup);
+}
+/*--------------------------------------------------------------------------------------*/
+// The only color byte is 1 for the pixel on
+void DMD_MonoChrome_SPI::getColorBytes(uint8_t* cbytes, uint16_t color) {
+	cbytes[0] = ((uint8_t)(color ^ inverse_ALL_flag) == true) ? 1 : 0;
+}
+/*--------------------------------------------------------------------------------------*/
+// Draw up to 8 pixels of the hbyte bits (MSB first) or a solid span of bsize pixels (hbyte = 0xff).
+void DMD_MonoChrome_SPI::drawHByte(int16_t x, int16_t y, uint8_t hbyte, uint16_t bsize, uint8_t* fg_col_bytes,
+	uint8_t* bg_col_bytes) {
+
+	draw_line_run(x, y, hbyte, bsize, fg_col_bytes, bg_col_bytes, false);
+}
+/*--------------------------------------------------------------------------------------*/
+// The run goes to the right (or down if vertical) on the screen, and in the buffer
+// it goes by parts along the lines or across them, as the screen is rotated.
+// Pixels of the buffer line are 8 per byte, so the part along the line is written by the byte masks,
+// the part going to the left is written from its left end with reversed bits.
+// The pixels of the part across the lines are at the same bit of the line bytes.
+// Without bg_col_bytes the zero bits are transparent.
+void DMD_MonoChrome_SPI::draw_line_run(int16_t x, int16_t y, uint8_t hbyte, uint16_t bsize, uint8_t* fg_col_bytes,
+	uint8_t* bg_col_bytes, bool vertical) {
+
+	if (tile_cells || !clip_run(x, y, hbyte, bsize, vertical)) return;
+
+	DMD_RasterOp rop = get_raster_op(graph_mode);
+	uint8_t fg_mask = fg_col_bytes[0] ? 0xFF : 0;
+	uint8_t bg_mask = (bg_col_bytes && bg_col_bytes[0]) ? 0xFF : 0;
+
+	while (bsize) {
+		// transform X & Y for Rotate and connect scheme
+		int16_t bX = x, bY = y;
+		transform_XY(bX, bY);
+		uint8_t dir;
+		uint16_t n = line_run(bX, bY, dir, vertical);
+		if (n > bsize) n = bsize;
+		uint8_t pattern = hbyte;
+
+		if (dir & 1) {
+			uint8_t lookup = bPixelLookupTable[bX & 0x07];
+			uint16_t x_offset = (bX / 8) * DMD_MONO_SCAN;
+			for (uint16_t j = 0; j < n; j++) {
+				uint8_t* ptr = bDMDScreenRAM + line_offset(bY) + x_offset;
+				uint8_t span = (bg_col_bytes || (pattern & 0x80)) ? lookup : 0;
+				uint8_t on = span & ((pattern & 0x80) ? fg_mask : bg_mask);
+				// zero bit is pixel on
+				*ptr = ~rop.apply((uint8_t)~*ptr, on, span);
+				if (hbyte != 0xff) pattern <<= 1;
+				bY += (dir == 1) ? 1 : -1;
 			}
-			break;
-		case GRAPHICS_OR:
-			//only set pixels on
-			if (bPixel == true)
-				bDMDScreenRAM[uiDMDRAMPointer] &= ~lookup;	// zero bit is pixel on
-			break;*/
-	case GRAPHICS_NOR:
-		//only clear on pixels
-		if ((bPixel == true) &&
-			((bDMDScreenRAM[uiDMDRAMPointer] & lookup) == 0))
-			bDMDScreenRAM[uiDMDRAMPointer] |= lookup;	// one bit is pixel off
-		break;
+		}
+		else {
+			if (dir == 2) {
+				bX -= n - 1;
+				if (hbyte != 0xff) pattern = reverse_bits(hbyte) << (8 - n);
+			}
+			uint8_t* ptr = bDMDScreenRAM + line_offset(bY) + (bX / 8) * DMD_MONO_SCAN;
+			uint8_t bit = bX & 0x07;
+			uint16_t cnt = n;
+
+			while (cnt) {
+				uint8_t m = (cnt > (8 - bit)) ? (8 - bit) : cnt;
+				uint8_t span = (0xFF >> bit) & ~(0xFF >> (bit + m));
+				uint8_t bits = pattern >> bit;
+				if (!bg_col_bytes) span &= bits;
+				// bits of the pixels on
+				uint8_t on = span & ((bits & fg_mask) | (~bits & bg_mask));
+				// zero bit is pixel on
+				*ptr = ~rop.apply((uint8_t)~*ptr, on, span);
+				if (hbyte != 0xff) pattern <<= m;
+				cnt -= m;
+				bit = 0;
+				ptr += DMD_MONO_SCAN;
+			}
+		}
+		if (hbyte != 0xff) hbyte <<= n;
+		if (vertical) y += n;
+		else x += n;
+		bsize -= n;
 	}
 }
 /*--------------------------------------------------------------------------------------*/
+void DMD_MonoChrome_SPI::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+
+	if (w <= 0) return;
+
+	if (fast_Hbyte) {
+		uint8_t fg_col_bytes[1];
+		getColorBytes(fg_col_bytes, color);
+		drawHByte(x, y, 0xff, w, fg_col_bytes, fg_col_bytes);
+	}
+	else {
+		for (int16_t xx = 0; xx < w; xx++) {
+			drawPixel(x + xx, y, color);
+		}
+	}
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_MonoChrome_SPI::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+
+	if (h <= 0) return;
+
+	if (fast_Hbyte) {
+		uint8_t fg_col_bytes[1];
+		getColorBytes(fg_col_bytes, color);
+		draw_line_run(x, y, 0xff, h, fg_col_bytes, fg_col_bytes, true);
+	}
+	else {
+		for (int16_t yy = 0; yy < h; yy++) {
+			drawPixel(x, y + yy, color);
+		}
+	}
+}
+/*--------------------------------------------------------------------------------------*/
+// The row cycle of the displays on the SPI buses (see scan_running_dmds()):
+// the tick stops the shared timers once, every display moves to the next row and starts
+// sending its data, then the timers are restarted. The display keeps showing the previous
+// row until its data is sent, then the mux and the latch are switched together,
+// so every row is shown for the same OE time of the tick.
+void DMD_MonoChrome_SPI::pauseRowTimers() {
+
+	timer_pause(MAIN_TIMER);
+	timer_pause(OE_TIMER);
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_MonoChrome_SPI::resumeRowTimers() {
+
+	timer_set_count(MAIN_TIMER, 0);
+	timer_set_count(OE_TIMER, 0);
+	timer_generate_update(MAIN_TIMER);
+	timer_generate_update(OE_TIMER);
+	timer_resume(OE_TIMER);
+	timer_resume(MAIN_TIMER);
+}
+/*--------------------------------------------------------------------------------------*/
+// The row of the data sent at this tick, the buffers are swapped at the end of the frame
+void DMD_MonoChrome_SPI::next_row() {
+
+	timer_set_compare(OE_TIMER, oe_channel, (scan_cycle_len * this->brightness) / 255);
+	if (++bDMDByte > 3) {
+		bDMDByte = 0;
+		frame_count++;
+		if (swapflag == true) {    // Swap front/back buffers if requested
+			backindex = 1 - backindex;
+			swapflag = false;
+			bDMDScreenRAM = matrixbuff[backindex]; // Back buffer
+			front_buff = matrixbuff[1 - backindex]; // -> front buffer
+		}
+	}
+}
+/*--------------------------------------------------------------------------------------*/
+// The data of the row is in the shift registers
+void DMD_MonoChrome_SPI::latch_row() {
+
+	set_mux(bDMDByte);
+	*latsetreg = latmask; // Latch data
+	*latsetreg = latmask << 16;// Latch down
+}
+/*--------------------------------------------------------------------------------------*/
 #if ( DMD_USE_DMA )
 
 void DMD_MonoChrome_SPI::latchDMA() {
@@ -193,7 +316,7 @@ void DMD_MonoChrome_SPI::latchDMA() {
 	dma_clear_isr_bits(spiDmaDev, spiTxDmaStream);
 #endif
 	DEBUG_TIME_MARK;
-	//switch_row();   // move to scanDisplay
+	latch_row();
 	DEBUG_TIME_MARK;
 }
 
@@ -201,22 +324,11 @@ void DMD_MonoChrome_SPI::latchDMA() {
 void DMD_MonoChrome_SPI::scanDisplayByDMA()
 {
 
-	switch_row();
+	next_row();
 
 	uint8_t* fr_buff = matrixbuff[1 - backindex]; // -> front buffer
-	//uint16_t offset = rowsize * bDMDByte;
-	uint8_t* offset_ptr = fr_buff + rowsize * bDMDByte;
-	uint8_t* row1_ptr = offset_ptr + row1;
-	uint8_t* row2_ptr = offset_ptr + row2;
-	uint8_t* row3_ptr = offset_ptr + row3;
-	uint8_t* buf_ptr = dmd_dma_buf;
-
-	for (int i = 0;i < rowsize;i++) {
-		*buf_ptr++ = *(row3_ptr++);
-		*buf_ptr++ = *(row2_ptr++);
-		*buf_ptr++ = *(row1_ptr++);
-		*buf_ptr++ = *(offset_ptr++);
-	}
+	// the buffer is in the shift-out order, so DMA reads the row directly
+	uint8_t* row_ptr = tile_cells ? build_tile_row(bDMDByte) : fr_buff + rowsize * DMD_MONO_SCAN * bDMDByte;
 #if defined(__STM32F1__) 
 	if (SPI_DMD.dev() == SPI1) {
 		SPI_DMD.onTransmit(SPI1_DMA_callback);
@@ -241,10 +353,171 @@ void DMD_MonoChrome_SPI::scanDisplayByDMA()
 		SPI_DMD.onTransmit(SPI3_DMA_callback);
 	}
 #endif
-	SPI_DMD.dmaSend(dmd_dma_buf, rowsize * 4, 1);
+	SPI_DMD.dmaSend(row_ptr, rowsize * DMD_MONO_SCAN, 1);
 	DEBUG_TIME_MARK;
 }
 
+#if defined(DMD_SPI_DMA_CHAIN)
+/*--------------------------------------------------------------------------------------
+ Chained refresh (STM32F4 only)
+ TIMER1 counts the row period. Its OC1REF, used as TRGO, is high while the row
+ data is sent and gates the MAIN_TIMER, which writes one byte of the front buffer
+ to SPI DR by DMA at every update. The buffer is kept in the shift-out order,
+ so the byte DMA runs circular over the whole frame.
+ At the end of the row period TIMER1 CC2 and CC3 requests DMA2 to write
+ LAT high with the mux value and then LAT low to the GPIO port, so OE
+ can be on for the rest of the period as in the interrupt-driven scan.
+ OE_TIMER is reset at the start of every row by the same trigger.
+ CPU is used only at the end of the frame to swap the buffers.
+--------------------------------------------------------------------------------------*/
+static volatile DMD_MonoChrome_SPI* chain_running_dmd = NULL;
+
+static void chain_frame_callback() {
+	DMD_MonoChrome_SPI* next = (DMD_MonoChrome_SPI*)chain_running_dmd;
+	next->chainFrameDone();
+}
+/*--------------------------------------------------------------------------------------*/
+bool DMD_MonoChrome_SPI::startDMAChain() {
+
+	// only one display can be refreshed by the chain
+	if (chain_running_dmd) return false;
+	// the chain reads the whole frame buffer, the tile rows are built by the row interrupts
+	if (tile_cells) return false;
+	// LAT and mux are written by one DMA stream
+	if (latsetreg != muxsetreg) return false;
+	// DMA1 can write to registers of SPI2 & SPI3 (APB1) only
+	if ((spi_num != 2) && (spi_num != 3)) return false;
+
+	// DMA requests of MAIN_TIMER update, the timer is triggered by TIMER1 on ITR0
+	if (MAIN_TIMER == TIMER4) {
+		chainByteDmaStream = DMA_STREAM6;
+		chainByteDmaChannel = DMA_CH2;
+	}
+	else if (MAIN_TIMER == TIMER3) {
+		chainByteDmaStream = DMA_STREAM2;
+		chainByteDmaChannel = DMA_CH5;
+	}
+	else return false;
+
+	// All timers are clocked at APB1 timer clock (CYCLES_PER_MICROSECOND / 2).
+	// Bytes are sent at two SPI byte times, so the SPI is always idle at the next byte
+	uint16_t byte_len = (8ul * CYCLES_PER_MICROSECOND * 1000000ul) / DMD_SPI_CLOCK;
+	uint32_t gate = (uint32_t)rowsize * DMD_MONO_SCAN * byte_len;
+	uint32_t period = scan_cycle_len / 2;
+	if ((gate + 3 * byte_len) > TIM_MAX_RELOAD) return false;   // too many panels
+	if (period < (gate + 3 * byte_len)) period = gate + 3 * byte_len;
+	if (period > TIM_MAX_RELOAD) period = TIM_MAX_RELOAD;
+	chain_oe_len = period - 2 * byte_len;
+
+	chain_mux_latch = (uint32_t*)malloc(nRows * 4);
+	if (chain_mux_latch == NULL) return false;
+	for (uint8_t i = 0; i < nRows; i++) chain_mux_latch[i] = mux_mask2[i] | latmask;
+	chain_latch_clr = latmask << 16;
+
+	// row timer
+	timer_init(TIMER1);
+	timer_pause(TIMER1);
+	timer_set_prescaler(TIMER1, 1);                      // APB2 timer clock / 2
+	timer_set_reload(TIMER1, period - 1);
+	timer_oc_set_mode(TIMER1, 1, TIMER_OC_MODE_PWM_1, 0);
+	timer_set_compare(TIMER1, 1, gate);                  // row data is sent while OC1REF is high
+	timer_set_compare(TIMER1, 2, period - 2 * byte_len); // LAT high & mux
+	timer_set_compare(TIMER1, 3, period - byte_len);     // LAT low
+	TIMER1_BASE->CR2 = TIMER_CR2_MMS_COMPARE_OC1REF;     // OC1REF as TRGO
+
+	// byte timer
+	timer_init(MAIN_TIMER);
+	timer_pause(MAIN_TIMER);
+	timer_set_prescaler(MAIN_TIMER, 0);
+	timer_set_reload(MAIN_TIMER, byte_len - 1);
+	(MAIN_TIMER->regs).gen->SMCR = TIMER_SMCR_TS_ITR0 | TIMER_SMCR_SMS_GATED;
+
+	// OE timer, restarted at every row
+	DMD::initialize_timers(NULL);
+	timer_pause(OE_TIMER);
+	(OE_TIMER->regs).gen->SMCR = TIMER_SMCR_TS_ITR0 | TIMER_SMCR_SMS_RESET;
+
+	// row data to SPI, DMA switches between M0AR and M1AR at every frame
+	uint8_t* fr_buff = matrixbuff[1 - backindex];
+	dma_init(DMA1);
+	dma_disable(DMA1, chainByteDmaStream);
+	dma_clear_isr_bits(DMA1, chainByteDmaStream);
+	dma_setup_transfer(DMA1, chainByteDmaStream, chainByteDmaChannel, DMA_SIZE_8BITS, &(SPI_DMD.dev()->regs->DR),
+		fr_buff, fr_buff, (DMA_MINC_MODE | DMA_FROM_MEM | DMA_CIRC_MODE | DMA_TRNS_CMPLT));
+	dma_set_num_transfers(DMA1, chainByteDmaStream, mem_Buffer_Size);
+	DMA1->regs->STREAM[chainByteDmaStream].CR |= (1 << 18);   // DBM: double buffer mode
+	dma_attach_interrupt(DMA1, chainByteDmaStream, chain_frame_callback);
+
+	// LAT & mux to GPIO port
+	dma_init(DMA2);
+	dma_disable(DMA2, DMA_STREAM2);
+	dma_disable(DMA2, DMA_STREAM6);
+	dma_clear_isr_bits(DMA2, DMA_STREAM2);
+	dma_clear_isr_bits(DMA2, DMA_STREAM6);
+	dma_setup_transfer(DMA2, DMA_STREAM2, DMA_CH6, DMA_SIZE_32BITS, latsetreg, chain_mux_latch, NULL, (DMA_MINC_MODE | DMA_FROM_MEM | DMA_CIRC_MODE));
+	dma_set_num_transfers(DMA2, DMA_STREAM2, nRows);
+	dma_setup_transfer(DMA2, DMA_STREAM6, DMA_CH6, DMA_SIZE_32BITS, latsetreg, &chain_latch_clr, NULL, (DMA_FROM_MEM | DMA_CIRC_MODE));
+	dma_set_num_transfers(DMA2, DMA_STREAM6, 1);
+
+	// load timer registers before DMA requests enabled
+	timer_generate_update(TIMER1);
+	timer_generate_update(MAIN_TIMER);
+	TIMER1_BASE->SR = 0;
+	(MAIN_TIMER->regs).gen->SR = 0;
+	timer_dma_enable_req(TIMER1, 2);
+	timer_dma_enable_req(TIMER1, 3);
+	timer_dma_enable_upd_req(MAIN_TIMER);
+
+	dma_enable(DMA1, chainByteDmaStream);
+	dma_enable(DMA2, DMA_STREAM2);
+	dma_enable(DMA2, DMA_STREAM6);
+
+	chain_running_dmd = this;
+	setBrightness(brightness);
+	timer_set_count(MAIN_TIMER, 0);
+	timer_set_count(OE_TIMER, 0);
+	timer_set_count(TIMER1, 0);
+	timer_resume(MAIN_TIMER);
+	timer_resume(OE_TIMER);
+	timer_resume(TIMER1);       // the row timer starts the chain
+	return true;
+}
+/*--------------------------------------------------------------------------------------*/
+// Called by DMA at the end of the every frame, when the DMA has switched
+// to the other memory register (CT bit). The register not in use may be changed.
+void DMD_MonoChrome_SPI::chainFrameDone() {
+
+	dma_clear_isr_bits(DMA1, chainByteDmaStream);
+	frame_count++;
+	volatile uint32_t* idle_addr = &(DMA1->regs->STREAM[chainByteDmaStream].M1AR);
+	if (DMA1->regs->STREAM[chainByteDmaStream].CR & (1 << 19)) idle_addr = &(DMA1->regs->STREAM[chainByteDmaStream].M0AR);
+
+	if (chain_swap_pending) {
+		// DMA reads the new front buffer from now
+		backindex = 1 - backindex;
+		bDMDScreenRAM = matrixbuff[backindex]; // Back buffer
+		front_buff = matrixbuff[1 - backindex]; // -> front buffer
+		chain_swap_pending = false;
+		swapflag = false;
+	}
+	else if (swapflag) {
+		// the frame after the next will be read from the back buffer,
+		// the swap is completed when DMA starts it
+		*idle_addr = (uint32_t)matrixbuff[backindex];
+		chain_swap_pending = true;
+		return;
+	}
+	*idle_addr = (uint32_t)matrixbuff[1 - backindex];
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_MonoChrome_SPI::setBrightness(uint8_t level) {
+	this->brightness = level;
+	// OE_TIMER isn't updated at every row in the chained mode
+	if (chain_running_dmd == this)
+		timer_set_compare(OE_TIMER, oe_channel, ((uint32_t)chain_oe_len * level) / 255);
+}
+#endif
+
 #else
 /*--------------------------------------------------------------------------------------
  Scan the dot matrix LED panel display, from the RAM mirror out to the display hardware.
@@ -254,61 +527,228 @@ void DMD_MonoChrome_SPI::scanDisplayByDMA()
 //int i = 0;
 void DMD_MonoChrome_SPI::scanDisplayBySPI()
 {
-	uint16_t offset = rowsize * bDMDByte;
+	next_row();
+	uint16_t row_len = rowsize * DMD_MONO_SCAN;
+	uint16_t offset = row_len * bDMDByte;
 
 #if (defined(__STM32F1__) || defined(__STM32F4__))
 	//pwmWrite(pin_DMD_nOE, 0);
-
-	for (int i = 0;i < rowsize;i++) {
-		SPI_DMD.write(bDMDScreenRAM[offset + i + row3]);
-		SPI_DMD.write(bDMDScreenRAM[offset + i + row2]);
-		SPI_DMD.write(bDMDScreenRAM[offset + i + row1]);
+	if (tile_cells) {
+		uint8_t* row_ptr = build_tile_row(bDMDByte);
+		for (int i = 0;i < row_len;i++) SPI_DMD.write(row_ptr[i]);
+	}
+	else for (int i = 0;i < row_len;i++) {
 		SPI_DMD.write(bDMDScreenRAM[offset + i]);
 	}
 
 #elif defined(__AVR_ATmega328P__)
-	for (int i = 0;i < rowsize;i++) {
-		SPI.transfer(bDMDScreenRAM[offset + i + row3]);
-		SPI.transfer(bDMDScreenRAM[offset + i + row2]);
-		SPI.transfer(bDMDScreenRAM[offset + i + row1]);
+	for (int i = 0;i < row_len;i++) {
 		SPI.transfer(bDMDScreenRAM[offset + i]);
 	}
 	//OE_DMD_ROWS_OFF();
 #endif
-	switch_row();
+	latch_row();
 }
 // Shift entire screen one pixel
 #endif
 /*--------------------------------------------------------------------------------------*/
+// Shift entire screen by step pixels, left (step < 0) or right (step > 0)
+// The screen shift follows the rotation, it goes along or across the buffer lines
 void DMD_MonoChrome_SPI::shiftScreen(int8_t step) {
-	uint8_t msb_bit = 0x80;
-	uint8_t lsb_bit = 0x01;
-
-	if (inverse_ALL_flag) {
-		msb_bit = 0;
-		lsb_bit = 0;
+	if (tile_cells) return;
+	bool across;
+	step = buffer_shift(step, across);
+	if (across) shift_buffer_lines(step);
+	else shift_buffer(step);
+}
+/*--------------------------------------------------------------------------------------*/
+// Shift entire screen one line up (step < 0) or down (step > 0)
+void DMD_MonoChrome_SPI::shiftScreenVertical(int8_t step) {
+	if ((step == 0) || tile_cells) return;
+	bool across;
+	step = buffer_shift((step < 0) ? -1 : 1, across, true);
+	if (across) shift_buffer_lines(step);
+	else shift_buffer(step);
+}
+/*--------------------------------------------------------------------------------------*/
+// Shift the buffer lines by step pixels, left (step < 0) or right (step > 0)
+// Every 32-bit word of the buffer holds the same byte column of four panel lines,
+// so four lines are shifted at once, each byte of the word as a separate lane.
+// Pixels are MSB-first, the bits are carried between neighbour words.
+void DMD_MonoChrome_SPI::shift_buffer(int8_t step) {
+	uint8_t n = (step < 0) ? -step : step;
+	if (n == 0) return;
+
+	// fill bits for the columns came in from the edge
+	uint32_t fill = ((uint8_t)(textbgcolor ^ inverse_ALL_flag) == true) ? 0 : 0xFFFFFFFF;
+	if (n >= WIDTH) {
+		memset(bDMDScreenRAM, (uint8_t)fill, mem_Buffer_Size);
+		return;
 	}
+	int16_t line_words = WIDTH / 8;
+	int16_t word_shift = n / 8;
+	uint8_t bit_shift = n % 8;
+	uint32_t* line = (uint32_t*)bDMDScreenRAM;
+	uint32_t* buff_end = line + mem_Buffer_Size / 4;
+
+#define LINE_WORD(i) ((((i) >= 0) && ((i) < line_words)) ? line[(i)] : fill)
+
 	if (step < 0) {
-		for (int i = 0; i < mem_Buffer_Size;i++) {
-			if ((i % (DisplaysWide * 4)) == (DisplaysWide * 4) - 1) {
-				bDMDScreenRAM[i] = (bDMDScreenRAM[i] << 1) + lsb_bit;
+		// bits stayed in the lane after shift
+		uint32_t lane_mask = ((0xFF << bit_shift) & 0xFF) * 0x01010101ul;
+		for (; line < buff_end; line += line_words) {
+			for (int16_t i = 0; i < line_words; i++) {
+				line[i] = ((LINE_WORD(i + word_shift) << bit_shift) & lane_mask) |
+					((LINE_WORD(i + word_shift + 1) >> (8 - bit_shift)) & ~lane_mask);
 			}
-			else {
-				bDMDScreenRAM[i] = (bDMDScreenRAM[i] << 1) + ((bDMDScreenRAM[i + 1] & 0x80) >> 7);
+		}
+	}
+	else {
+		uint32_t lane_mask = (0xFF >> bit_shift) * 0x01010101ul;
+		for (; line < buff_end; line += line_words) {
+			for (int16_t i = line_words - 1; i >= 0; i--) {
+				line[i] = ((LINE_WORD(i - word_shift) >> bit_shift) & lane_mask) |
+					((LINE_WORD(i - word_shift - 1) << (8 - bit_shift)) & ~lane_mask);
 			}
 		}
 	}
+#undef LINE_WORD
+}
+
+/*--------------------------------------------------------------------------------------*/
+// Shift the buffer by step lines, up (step < 0) or down (step > 0)
+// Bytes of the panel line are DMD_MONO_SCAN bytes apart in the buffer,
+// so lines are moved by a strided byte copy
+void DMD_MonoChrome_SPI::shift_buffer_lines(int8_t step) {
+	uint16_t line_bytes = WIDTH / 8;
+	int8_t dir;
+	int16_t y_first, y_last;
+	int16_t n = (step < 0) ? -step : step;
+
+	if (step < 0) {
+		dir = -1; y_first = 0; y_last = HEIGHT - 1;
+	}
 	else if (step > 0) {
-		for (int i = (mem_Buffer_Size)-1; i >= 0;i--) {
-			if ((i % (DisplaysWide * 4)) == 0) {
-				bDMDScreenRAM[i] = (bDMDScreenRAM[i] >> 1) + msb_bit;
-			}
-			else {
-				bDMDScreenRAM[i] = (bDMDScreenRAM[i] >> 1) + ((bDMDScreenRAM[i - 1] & 1) << 7);
-			}
+		dir = 1; y_first = HEIGHT - 1; y_last = 0;
+	}
+	else return;
+	if (n > HEIGHT) n = HEIGHT;
+
+	// go against the shift direction, so each source line is read before it is overwritten
+	int16_t y = y_first;
+	for (int16_t k = n; k < HEIGHT; k++, y -= dir) {
+		uint8_t* dst = bDMDScreenRAM + line_offset(y);
+		uint8_t* src = bDMDScreenRAM + line_offset(y - dir * n);
+		for (uint16_t i = 0; i < line_bytes; i++) {
+			*dst = *src;
+			dst += DMD_MONO_SCAN; src += DMD_MONO_SCAN;
+		}
+	}
+	// fill the lines came in with background, zero bit is pixel on
+	uint8_t bg_byte = ((uint8_t)(textbgcolor ^ inverse_ALL_flag) == true) ? 0x00 : 0xFF;
+	for (int16_t k = 0; k < n; k++) {
+		uint8_t* dst = bDMDScreenRAM + line_offset(y_last + dir * k);
+		for (uint16_t i = 0; i < line_bytes; i++) {
+			*dst = bg_byte;
+			dst += DMD_MONO_SCAN;
 		}
 	}
 }
 
+/*--------------------------------------------------------------------------------------*/
+// The buffers are allocated before the mode is changed and released after it,
+// the pointers used by the scan are changed with interrupts off
+bool DMD_MonoChrome_SPI::setTileMode(const uint8_t* tileset, uint8_t tile_height, uint8_t* cells) {
+
+#if defined(DMD_SPI_DMA_CHAIN)
+	// the chain reads the whole frame buffer by DMA
+	if (chain_running_dmd == this) return false;
+#endif
+	if (tileset == NULL) {
+		if (tile_cells == NULL) return true;
+		uint16_t allocsize = (dbuf == true) ? (frame_size() * 2) : frame_size();
+		uint8_t* buff = (uint8_t*)malloc(allocsize);
+		if (buff == NULL) return false;
+		// all pixels off, as clearScreen(true) does
+		memset(buff, inverse_ALL_flag ? 0x00 : 0xFF, allocsize);
+		uint8_t* old_cells = own_cells ? tile_cells : NULL;
+		uint8_t* old_line = tile_line;
+
+		noInterrupts();
+		set_matrix(buff, frame_size(), dbuf);
+		tile_cells = NULL;
+		tile_line = NULL;
+		own_cells = false;
+		interrupts();
+
+		free(old_cells);
+		free(old_line);
+		return true;
+	}
+	if ((tile_height != 8) && (tile_height != 16)) return false;
+
+	uint16_t cells_cnt = (WIDTH / 8) * (HEIGHT / tile_height);
+	bool new_own = false;
+	if (cells == NULL) {
+		// the same number of cells can be kept
+		if (own_cells && (tile_height == this->tile_height)) cells = tile_cells;
+		else {
+			cells = (uint8_t*)malloc(cells_cnt);
+			if (cells == NULL) return false;
+			memset(cells, 0, cells_cnt);
+		}
+		new_own = true;
+	}
+	uint8_t* line = tile_line;
+	if (line == NULL) {
+		line = (uint8_t*)malloc(rowsize * DMD_MONO_SCAN);
+		if (line == NULL) {
+			if (new_own && (cells != tile_cells)) free(cells);
+			return false;
+		}
+	}
+	uint8_t* old_cells = (own_cells && (cells != tile_cells)) ? tile_cells : NULL;
+	uint8_t* old_buff = (tile_line == NULL) ? matrixbuff[0] : NULL;
+
+	noInterrupts();
+	this->tileset = tileset;
+	this->tile_height = tile_height;
+	own_cells = new_own;
+	tile_line = line;
+	set_matrix(line, rowsize * DMD_MONO_SCAN, false);
+	tile_cells = cells;
+	interrupts();
+
+	free(old_cells);
+	free(old_buff);
+	return true;
+}
+/*--------------------------------------------------------------------------------------*/
+// Bytes of the row go in the shift-out order, as they are in the frame buffer (see line_offset()):
+// for every panel line and byte column - the bytes of DMD_MONO_SCAN lines, the lowest line is the first.
+// The cells and the tile lines of these lines are taken once per panel line.
+uint8_t* DMD_MonoChrome_SPI::build_tile_row(uint8_t row) {
+
+	uint8_t cols = WIDTH / 8;
+	// zero bit is pixel on
+	uint8_t inv = inverse_ALL_flag ? 0 : 0xFF;
+	uint8_t* ptr = tile_line;
+	const uint8_t* cell_line[DMD_MONO_SCAN];
+	const uint8_t* tile_line_ptr[DMD_MONO_SCAN];
+
+	for (uint8_t panel_row = 0; panel_row < DisplaysHigh; panel_row++) {
+		for (uint8_t k = 0; k < DMD_MONO_SCAN; k++) {
+			uint16_t y = panel_row * DMD_PIXELS_DOWN + row + (DMD_MONO_SCAN - 1 - k) * DMD_MONO_SCAN;
+			cell_line[k] = tile_cells + (y / tile_height) * cols;
+			tile_line_ptr[k] = tileset + (y % tile_height);
+		}
+		for (uint8_t col = 0; col < cols; col++) {
+			for (uint8_t k = 0; k < DMD_MONO_SCAN; k++) {
+				*ptr++ = tile_line_ptr[k][cell_line[k][col] * tile_height] ^ inv;
+			}
+		}
+	}
+	return tile_line;
+}
 #endif
 
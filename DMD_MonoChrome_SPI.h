@@ -26,6 +26,10 @@
 #endif
 #define DMD_USE_DMA	1
 
+// chained refresh is implemented for STM32F4 only
+#if (defined(DMD_SPI_DMA_CHAIN) && !(defined(__STM32F4__) && DMD_USE_DMA))
+#undef DMD_SPI_DMA_CHAIN
+#endif
 
 
 class DMD_MonoChrome_SPI :
@@ -40,26 +44,89 @@ public:
 
 	void init(uint16_t scan_interval = 1000) override;
 	void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+	void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+	void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
 	void shiftScreen(int8_t step) override;
+	void shiftScreenVertical(int8_t step) override;
+
+	// Tile mode: the screen is a grid of cells 8 pixels wide and tile_height (8 or 16) lines high,
+	// every cell holds the index of the tile in the tileset (tile_height bytes per tile, MSB is the left pixel).
+	// The frame buffer is released, the scan builds every row from the tiles to the line buffer,
+	// so drawing and shifting have no effect until setTileMode(NULL).
+	// The chained DMA refresh can't be used: setTileMode() fails while the chain runs,
+	// and init() in the tile mode starts the refresh by the row interrupts.
+	// The cells go row by row in the buffer coordinates (rotation and connect scheme aren't applied),
+	// if cells is NULL they are allocated and cleared to tile 0.
+	bool setTileMode(const uint8_t* tileset, uint8_t tile_height = 8, uint8_t* cells = NULL);
+	void setTile(uint8_t col, uint8_t row, uint8_t index) {
+		if (tile_cells && (col < WIDTH / 8) && (row < HEIGHT / tile_height)) tile_cells[row * (WIDTH / 8) + col] = index;
+	}
+	uint8_t* getTileCells() { return tile_cells; }
 	
 #if (defined(__STM32F1__)|| defined(__STM32F4__)) 
 	uint8_t spi_num = 0;
 #endif
 
+	// the timers are shared by all displays, they are stopped once for all of them
+	// before the scan of the row and restarted after it
+	void pauseRowTimers();
+	void resumeRowTimers();
 #if ( DMD_USE_DMA )
+	// start the data of the next row, it's latched by latchDMA() from the DMA callback
 	void scanDisplayByDMA();
 	void latchDMA();
+#if defined(DMD_SPI_DMA_CHAIN)
+	void setBrightness(uint8_t level) override;
+	void chainFrameDone();
+#endif
 #else
 	void scanDisplayBySPI();
 #endif
 protected:
 	void set_pin_modes() override;
+	void drawHByte(int16_t x, int16_t y, uint8_t hbyte, uint16_t bsize, uint8_t* fg_col_bytes,
+		uint8_t* bg_col_bytes) override;
+	void getColorBytes(uint8_t* cbytes, uint16_t color) override;
+	// draw the run of hbyte bits or solid run (hbyte = 0xff) to the right or down if vertical
+	void draw_line_run(int16_t x, int16_t y, uint8_t hbyte, uint16_t bsize, uint8_t* fg_col_bytes,
+		uint8_t* bg_col_bytes, bool vertical);
+	// shift along the buffer lines by step pixels or across them by step lines
+	void shift_buffer(int8_t step);
+	void shift_buffer_lines(int8_t step);
+	// move to the next row at the tick, switch the mux and latch when the row data is sent
+	void next_row();
+	void latch_row();
+	// size of the whole screen frame buffer
+	uint16_t frame_size() {
+		return DisplaysTotal * ((DMD_PIXELS_ACROSS * DMD_BITSPERPIXEL / 8) * DMD_PIXELS_DOWN);
+	}
+	// set the pointers of the frame buffer (or the tile line buffer) of size bytes, single or double
+	void set_matrix(uint8_t* buff, uint16_t size, bool double_buf);
+	// shift-out data of the row from the tiles, returns the line buffer
+	uint8_t* build_tile_row(uint8_t row);
 private:
 	byte pin_DMD_R_DATA;   // is SPI Master Out 
-	uint16_t rowsize, row1, row2, row3;
+	uint16_t rowsize;
+
+	// The buffer is kept in the shift-out order: for every mux row
+	// the bytes of four interleaved panel lines follow each other.
+	// Returns offset of the first byte of screen line y,
+	// next bytes of the line are DMD_MONO_SCAN bytes apart
+	uint16_t line_offset(int16_t y) {
+		uint8_t panel_y = y % DMD_PIXELS_DOWN;
+		return (panel_y % DMD_MONO_SCAN) * rowsize * DMD_MONO_SCAN +
+			(y / DMD_PIXELS_DOWN) * (WIDTH / 8) * DMD_MONO_SCAN +
+			(DMD_MONO_SCAN - 1 - panel_y / DMD_MONO_SCAN);
+	}
 
 	SPIClass SPI_DMD;
 
+	const uint8_t* tileset = NULL;
+	uint8_t* tile_cells = NULL;
+	uint8_t tile_height = 8;
+	bool own_cells = false;
+	uint8_t* tile_line = NULL;
+
 #if (DMD_USE_DMA)
 
 #if defined(__STM32F1__) 
@@ -71,7 +138,17 @@ private:
 	dma_stream   spiTxDmaStream;
 #endif
 
-	uint8_t* dmd_dma_buf;
+#if defined(DMD_SPI_DMA_CHAIN)
+	bool startDMAChain();
+	// LAT high + mux value for every row and LAT low words, written to the port by DMA
+	uint32_t* chain_mux_latch = NULL;
+	uint32_t chain_latch_clr;
+	// OE time of the row at full brightness, up to the mux switch
+	uint16_t chain_oe_len = 0;
+	volatile bool chain_swap_pending = false;
+	dma_stream chainByteDmaStream;
+	dma_channel chainByteDmaChannel;
+#endif
 
 #endif
 
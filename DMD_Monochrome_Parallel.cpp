@@ -14,16 +14,27 @@ void inline __attribute__((always_inline)) scan_running_dmd()
 	DMD_Monochrome_Parallel* next = (DMD_Monochrome_Parallel*)running_dmd;
 	next->scan_dmd();
 }
+#if defined(PARALLEL_DMA)
+static void parallel_row_callback() {
+	DMD_Monochrome_Parallel* next = (DMD_Monochrome_Parallel*)running_dmd;
+	next->rowDataDone();
+}
+#endif
 
 /*--------------------------------------------------------------------------------------*/
 DMD_Monochrome_Parallel::DMD_Monochrome_Parallel(byte _pin_A, byte _pin_B, byte _pin_nOE, byte _pin_SCLK, uint8_t* pinlist,
 	byte panelsWide, byte panelsHigh,
-	bool d_buf, byte dmd_pixel_x, byte dmd_pixel_y)
-	:DMD(new DMD_Pinlist(_pin_A, _pin_B), _pin_nOE, _pin_SCLK, panelsWide, panelsHigh, DMD_MONO_SCAN, new DMD_Pinlist(panelsHigh+1, pinlist),
-		d_buf, dmd_pixel_x, dmd_pixel_y)
+	bool d_buf, byte dmd_pixel_x, byte dmd_pixel_y, uint8_t gray_bits)
+	:DMD(new DMD_Pinlist(_pin_A, _pin_B), _pin_nOE, _pin_SCLK, panelsWide, limit_rows(panelsHigh), DMD_MONO_SCAN,
+		new DMD_Pinlist(limit_rows(panelsHigh) + 1, pinlist), d_buf, dmd_pixel_x, dmd_pixel_y)
 {
-	mem_Buffer_Size = DMD_PIXELS_ACROSS * panelsWide * DMD_PIXELS_DOWN;
-	x_len = mem_Buffer_Size / DMD_MONO_SCAN;
+	// x_len and addresses are counted in buffer cells
+	x_len = DMD_PIXELS_ACROSS * panelsWide * DMD_PIXELS_DOWN / DMD_MONO_SCAN;
+	plane_cells = x_len * DMD_MONO_SCAN;
+	if (gray_bits > 4) gray_bits = 4;
+	if (gray_bits > 1) nPlanes = gray_bits;
+	gray_max = (1 << nPlanes) - 1;
+	mem_Buffer_Size = plane_cells * nPlanes * sizeof(ParallelCellType);
 	
 	// Allocate and initialize matrix buffer:
 	uint16_t allocsize = (dbuf == true) ? (mem_Buffer_Size * 2) : mem_Buffer_Size;
@@ -34,6 +45,7 @@ DMD_Monochrome_Parallel::DMD_Monochrome_Parallel(byte _pin_A, byte _pin_B, byte
 	backindex = 0;
 	bDMDScreenRAM = matrixbuff[backindex]; // Back buffer
 	front_buff = matrixbuff[1 - backindex]; // -> front buffer
+	fast_Hbyte = true;
 	
 	running_dmd = this;
 }
@@ -47,10 +59,6 @@ void DMD_Monochrome_Parallel::set_pin_modes() {
 
 #if (defined(__STM32F1__) || defined(__STM32F4__))
 	DMD::set_pin_modes();
-#ifdef USE_UPPER_8BIT
-	clk_clrmask_low = clk_clrmask >> 8;
-	clkmask_low = clkmask >> 8;
-#endif // USE_UPPER_8BIT
 #endif
 
 	for (byte i = 0; i < this->data_pins_cnt; i++) {
@@ -62,14 +70,153 @@ void DMD_Monochrome_Parallel::set_pin_modes() {
         this->clk_clrmask |= (1 << (i));		
 #endif
 	}
+#if defined(PARALLEL_DMA)
+	dma_clr_mask = clk_clrmask << 16;
+#endif
 
+}
+/*--------------------------------------------------------------------------------------*/
+#if defined(PARALLEL_DMA)
+// Row data is sent to the port by two DMA streams, paced by DMA_TIMER:
+// CH3 request writes dma_clr_mask (CLK low, data cleared),
+// CH1 request writes the next buffer cell (data bits and CLK high).
+// The timer is stopped by the transfer complete interrupt of the data stream.
+void DMD_Monochrome_Parallel::initialize_timers(voidFuncPtr handler) {
+
+	DMD::initialize_timers(handler);
+
+	// DMA timer setup
+	timer_init(DMA_TIMER);
+	timer_pause(DMA_TIMER);
+	DMA_TIMER_BASE->DIER |= (1 << 11) | (1 << 9);  //CH1 & CH3 DMA request enable
+	DMA_TIMER_BASE->PSC = 0;
+	DMA_TIMER_BASE->ARR = dma_cell_period - 1;
+	DMA_TIMER_BASE->CCR3 = dma_cell_period / 4;    // 1 dma request 
+	DMA_TIMER_BASE->CCR1 = dma_cell_period * 3 / 4;   // 2 dma request
+
+	// dma setup
+	dma_init(parDmaDev);
+	uint8_t* ptr_t = matrixbuff[1 - backindex];
+	dma_disable(parDmaDev, clkTxDmaStream);
+	dma_disable(parDmaDev, datTxDmaStream);
+	dma_clear_isr_bits(parDmaDev, datTxDmaStream);
+	dma_clear_isr_bits(parDmaDev, clkTxDmaStream);
+#if defined(USE_16BIT_PARALLEL)
+	dma_setup_transfer(parDmaDev, datTxDmaStream, DmaDataChannel, DMA_SIZE_16BITS, (uint16_t*)datasetreg, (uint16_t*)ptr_t, NULL, (DMA_MINC_MODE | DMA_FROM_MEM | DMA_TRNS_CMPLT));
+#elif defined(USE_UPPER_8BIT)
+	// the cell goes to the upper byte of the BSRR set half
+	dma_setup_transfer(parDmaDev, datTxDmaStream, DmaDataChannel, DMA_SIZE_8BITS, (uint8_t*)datasetreg + 1, (uint8_t*)ptr_t, NULL, (DMA_MINC_MODE | DMA_FROM_MEM | DMA_TRNS_CMPLT));
+#else
+	dma_setup_transfer(parDmaDev, datTxDmaStream, DmaDataChannel, DMA_SIZE_8BITS, (uint8_t*)datasetreg, (uint8_t*)ptr_t, NULL, (DMA_MINC_MODE | DMA_FROM_MEM | DMA_TRNS_CMPLT));
+#endif
+	dma_set_num_transfers(parDmaDev, datTxDmaStream, x_len);
+	dma_attach_interrupt(parDmaDev, datTxDmaStream, parallel_row_callback);
+
+	// 2 nd dma stream
+	dma_setup_transfer(parDmaDev, clkTxDmaStream, DmaClkChannel, DMA_SIZE_32BITS, (uint32_t*)datasetreg, (uint32_t*)&dma_clr_mask, NULL, (DMA_CIRC_MODE | DMA_FROM_MEM));
+	dma_set_num_transfers(parDmaDev, clkTxDmaStream, 1);
+
+	dma_enable(parDmaDev, clkTxDmaStream);
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_Monochrome_Parallel::rowDataDone() {
+
+	dma_clear_isr_bits(parDmaDev, datTxDmaStream);
+	timer_pause(DMA_TIMER);
+	// CLK low after the last cell, the clock stream could be stopped before its request
+	*datasetreg = dma_clr_mask;
+}
+#endif
+/*--------------------------------------------------------------------------------------*/
+uint32_t DMD_Monochrome_Parallel::row_send_time() {
+
+#if defined(PARALLEL_DMA)
+	// DMA_TIMER is clocked at the CPU clock
+	return ((uint32_t)x_len * dma_cell_period) / CYCLES_PER_MICROSECOND + 1;
+#elif (defined(__STM32F1__) || defined(__STM32F4__))
+	// the speed of the GPIO writes depends on the bus, so the output is measured.
+	// The first row of the front buffer is latched by the first interrupt anyway.
+	uint32_t best = 0xFFFFFFFF;
+	for (uint8_t i = 0; i < 2; i++) {
+		uint32_t start = micros();
+		send_row((ParallelCellType*)matrixbuff[1 - backindex]);
+		uint32_t t = micros() - start;
+		if (t < best) best = t;
+	}
+	return best + 1;
+#else
+	return (uint32_t)(x_len / 64 + 1) * transfer64cells_time;
+#endif
 }
 /*--------------------------------------------------------------------------------------*/
 void DMD_Monochrome_Parallel::init(uint16_t scan_interval)
 {
 	DMD::init(scan_interval);
+	if (nPlanes > 1) {
+		// the row time is shared by the planes, so the frame rate is the same as in 1-bit mode,
+		// unless the shortest plane is less than the time to send the row data
+		uint32_t unit = scan_cycle_len / gray_max;
+		uint32_t min_unit = row_send_time() * CYCLES_PER_MICROSECOND;
+		if (unit < min_unit) unit = min_unit;
+		// the timers are set up for the longest plane
+		scan_cycle_len = unit << (nPlanes - 1);
+	}
 	this->initialize_timers(scan_running_dmd);
+	if (nPlanes > 1) {
+		scan_cycle_len >>= (nPlanes - 1);
+		textcolor = gray_max;
+	}
+
+}
+/*--------------------------------------------------------------------------------------*/
+// In grayscale mode every row is shown nPlanes times, the data of the plane p
+// loaded by the prior interrupt is shown for (scan_cycle_len << p)
+void DMD_Monochrome_Parallel::switch_row() {
+
+	if (nPlanes == 1) {
+		DMD::switch_row();
+		return;
+	}
+#if (defined(__STM32F1__) || defined(__STM32F4__))
+	// switch all LED OFF
+	timer_pause(MAIN_TIMER);
+	timer_pause(OE_TIMER);
+
+	uint32_t duration = scan_cycle_len << plane;
+	timer_set_reload(MAIN_TIMER, duration);
+	timer_set_compare(OE_TIMER, oe_channel, (duration * this->brightness) / 255);
+#endif
 
+	this->set_mux(bDMDByte);
+
+	if (++plane >= nPlanes) {
+		plane = 0;
+		if (++bDMDByte > 3) {
+			bDMDByte = 0;
+			frame_count++;
+			if (swapflag == true) {    // Swap front/back buffers if requested
+				backindex = 1 - backindex;
+				swapflag = false;
+				bDMDScreenRAM = matrixbuff[backindex]; // Back buffer
+				front_buff = matrixbuff[1 - backindex]; // -> front buffer
+			}
+		}
+	}
+
+#if (defined(__STM32F1__) || defined(__STM32F4__))
+	*latsetreg = latmask; // Latch data loaded during *prior* interrupt
+	*latsetreg = latmask << 16;// Latch down
+#if (CYCLES_PER_MICROSECOND > 100)
+	delayMicroseconds(1);
+#endif
+	// reenable LEDs, restart timers
+	timer_set_count(MAIN_TIMER, 0);
+	timer_set_count(OE_TIMER, 0);
+	timer_generate_update(MAIN_TIMER);
+	timer_generate_update(OE_TIMER);
+	timer_resume(OE_TIMER);
+	timer_resume(MAIN_TIMER);
+#endif
 }
 /*--------------------------------------------------------------------------------------*/
 
@@ -77,8 +224,6 @@ void DMD_Monochrome_Parallel::init(uint16_t scan_interval)
 /*--------------------------------------------------------------------------------------*/
 void DMD_Monochrome_Parallel::drawPixel(int16_t x, int16_t y, uint16_t color) {
 
-	unsigned int uiDMDRAMPointer;
-	uint8_t bPixel = color;
 	int16_t bX = x;
 	int16_t bY = y;
 	if (bX >= (_width) || bY >= (_height)) {
@@ -91,63 +236,122 @@ void DMD_Monochrome_Parallel::drawPixel(int16_t x, int16_t y, uint16_t color) {
 	// transform X & Y for Rotate and connect scheme
 	transform_XY(bX, bY);
 
-	// inverse data bits for some panels
-	bPixel = bPixel ^ inverse_ALL_flag;
-	byte panel_row = bY / DMD_PIXELS_DOWN;
-	byte panel_bY = bY % DMD_PIXELS_DOWN;
-	byte mux = panel_bY % 4;
-	byte mux_byte_cnt = panel_bY / 4;
-	uiDMDRAMPointer = mux * x_len + (bX / 8) * column_size + (3 - mux_byte_cnt) * 8 + bX % 8;
-
-#if (defined(ARDUINO_ARCH_RP2040))
-    byte lookup = (1<<panel_row);
-#elif (defined(__STM32F1__) || defined(__STM32F4__))	
-#ifdef USE_UPPER_8BIT
-	byte lookup = row_mask[panel_row] >> 8;
-#else
-	byte lookup = row_mask[panel_row];
-#endif
-#endif
+	ParallelCellType lookup;
+	ParallelCellType* cell = pixel_cell(bX, bY, lookup);
+	write_cell(cell, lookup, pixel_level(color), get_raster_op(graph_mode));
+}
+/*--------------------------------------------------------------------------------------*/
+// The only color byte is the pixel level
+void DMD_Monochrome_Parallel::getColorBytes(uint8_t* cbytes, uint16_t color) {
+	cbytes[0] = pixel_level(color);
+}
+/*--------------------------------------------------------------------------------------*/
+// Draw up to 8 pixels of the hbyte bits (MSB first) or a solid span of bsize pixels (hbyte = 0xff).
+void DMD_Monochrome_Parallel::drawHByte(int16_t x, int16_t y, uint8_t hbyte, uint16_t bsize, uint8_t* fg_col_bytes,
+	uint8_t* bg_col_bytes) {
 
-	switch (graph_mode) {
-	case GRAPHICS_NORMAL:
-		if (bPixel == true)
-			bDMDScreenRAM[uiDMDRAMPointer] &= ~lookup;	// zero bit is pixel on
-		else
-			bDMDScreenRAM[uiDMDRAMPointer] |= lookup;	// one bit is pixel off
-		break;
-		/*case GRAPHICS_INVERSE:
-			if (bPixel == false)
-				bDMDScreenRAM[uiDMDRAMPointer] &= ~lookup;	// zero bit is pixel on
-			else
-				bDMDScreenRAM[uiDMDRAMPointer] |= lookup;	// one bit is pixel off
-			break;
-		case GRAPHICS_TOGGLE:
-			if (bPixel == true) {
-			if ((bDMDScreenRAM[uiDMDRAMPointer] & lookup) == 0)
-				bDMDScreenRAM[uiDMDRAMPointer] |= lookup;	// one bit is pixel off
-			else
-				bDMDScreenRAM[uiDMDRAMPointer] &= ~lookup;	// one bit is pixel off
+	draw_line_run(x, y, hbyte, bsize, fg_col_bytes, bg_col_bytes, false);
+}
+/*--------------------------------------------------------------------------------------*/
+// The run goes to the right (or down if vertical) on the screen, and in the buffer
+// it goes by parts along the lines or across them, as the screen is rotated.
+// The line pixels are 8 consecutive cells in every column group, column_size cells apart.
+// Without bg_col_bytes the zero bits are transparent.
+void DMD_Monochrome_Parallel::draw_line_run(int16_t x, int16_t y, uint8_t hbyte, uint16_t bsize, uint8_t* fg_col_bytes,
+	uint8_t* bg_col_bytes, bool vertical) {
+
+	if (!clip_run(x, y, hbyte, bsize, vertical)) return;
+
+	DMD_RasterOp rop = get_raster_op(graph_mode);
+
+	while (bsize) {
+		// transform X & Y for Rotate and connect scheme
+		int16_t bX = x, bY = y;
+		transform_XY(bX, bY);
+		uint8_t dir;
+		uint16_t n = line_run(bX, bY, dir, vertical);
+		if (n > bsize) n = bsize;
+
+		ParallelCellType lookup;
+		ParallelCellType* cell = pixel_cell(bX, bY, lookup);
+		uint8_t bit = bX & 0x07;
+
+		for (uint16_t j = 0; j < n; j++) {
+			if (j) {
+				switch (dir) {
+				case 0:
+					// next column group after the 8th pixel
+					if (++bit == 8) {
+						bit = 0;
+						cell += column_size - 7;
+					}
+					else cell++;
+					break;
+				case 2:
+					if (bit-- == 0) {
+						bit = 7;
+						cell -= column_size - 7;
+					}
+					else cell--;
+					break;
+				default:
+					bY += (dir == 1) ? 1 : -1;
+					cell = pixel_cell(bX, bY, lookup);
+				}
+			}
+			uint8_t level = fg_col_bytes[0];
+			if (hbyte != 0xff) {
+				bool on = hbyte & 0x80;
+				hbyte <<= 1;
+				if (!on) {
+					if (!bg_col_bytes) continue;
+					level = bg_col_bytes[0];
+				}
 			}
-			break;
-		case GRAPHICS_OR:
-			//only set pixels on
-			if (bPixel == true)
-				bDMDScreenRAM[uiDMDRAMPointer] &= ~lookup;	// zero bit is pixel on
-			break;*/
-	case GRAPHICS_NOR:
-		//only clear on pixels
-		if ((bPixel == true) &&
-			((bDMDScreenRAM[uiDMDRAMPointer] & lookup) == 0))
-			bDMDScreenRAM[uiDMDRAMPointer] |= lookup;	// one bit is pixel off
-		break;
+			write_cell(cell, lookup, level, rop);
+		}
+		if (vertical) y += n;
+		else x += n;
+		bsize -= n;
+	}
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_Monochrome_Parallel::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+
+	if (w <= 0) return;
+
+	if (fast_Hbyte) {
+		uint8_t fg_col_bytes[1];
+		getColorBytes(fg_col_bytes, color);
+		drawHByte(x, y, 0xff, w, fg_col_bytes, fg_col_bytes);
+	}
+	else {
+		for (int16_t xx = 0; xx < w; xx++) {
+			drawPixel(x + xx, y, color);
+		}
+	}
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_Monochrome_Parallel::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+
+	if (h <= 0) return;
+
+	if (fast_Hbyte) {
+		uint8_t fg_col_bytes[1];
+		getColorBytes(fg_col_bytes, color);
+		draw_line_run(x, y, 0xff, h, fg_col_bytes, fg_col_bytes, true);
+	}
+	else {
+		for (int16_t yy = 0; yy < h; yy++) {
+			drawPixel(x, y + yy, color);
+		}
 	}
 }
 /*--------------------------------------------------------------------------------------*/
 void  DMD_Monochrome_Parallel::scan_dmd() {
 	
 #if (defined(ARDUINO_ARCH_RP2040))
-	uint32_t duration = this->scan_cycle_len;
+	uint32_t duration = this->scan_cycle_len << plane;   // plane loaded by the prior interrupt
 	pwm_clear_irq(MAIN_slice_num);				// clear PWM irq
 	pwm_set_enabled(MAIN_slice_num, false);		// stop MAIN timer
 	pwm_set_enabled(OE_slice_num, false);		// stop OE timer
@@ -159,9 +363,9 @@ void  DMD_Monochrome_Parallel::scan_dmd() {
 #endif
 	switch_row();
 
-	uint16_t offset = x_len * bDMDByte;
-	uint8_t* fr_buff = matrixbuff[1 - backindex]; // -> front buffer
-	uint8_t* ptr = fr_buff + offset;
+	uint16_t offset = x_len * bDMDByte + plane_cells * plane;
+	ParallelCellType* fr_buff = (ParallelCellType*)matrixbuff[1 - backindex]; // -> front buffer
+	ParallelCellType* ptr = fr_buff + offset;
 
 #if (defined(ARDUINO_ARCH_RP2040))
 	
@@ -172,9 +376,31 @@ void  DMD_Monochrome_Parallel::scan_dmd() {
 	pwm_set_enabled(MAIN_slice_num, true);
 	pwm_set_enabled(OE_slice_num, true);
 
+#elif defined(PARALLEL_DMA)
+	timer_pause(DMA_TIMER);
+	dma_disable(parDmaDev, datTxDmaStream);
+	dma_set_mem_addr(parDmaDev, datTxDmaStream, ptr);
+	dma_clear_isr_bits(parDmaDev, datTxDmaStream);
+	dma_set_num_transfers(parDmaDev, datTxDmaStream, x_len);
+	dma_enable(parDmaDev, datTxDmaStream);
+
+	DMA_TIMER_BASE->CNT = 0;
+	DMA_TIMER_BASE->CR1 = (1 << 0);
+
 #elif (defined(__STM32F1__) || defined(__STM32F4__))
+	send_row(ptr);
+#endif
+	DEBUG_TIME_MARK;
+	//switch_row();
+	DEBUG_TIME_MARK;
+
+}
+/*--------------------------------------------------------------------------------------*/
+#if (defined(__STM32F1__) || defined(__STM32F4__)) && !defined(PARALLEL_DMA)
+void DMD_Monochrome_Parallel::send_row(ParallelCellType* ptr) {
+
 	uint16_t cnt = 0;
-	static const PortType all_clr_mask = clk_clrmask << 16;
+	PortType all_clr_mask = clk_clrmask << 16;
 	
 #ifdef USE_UPPER_8BIT
 #define pew                    \
@@ -182,6 +408,7 @@ void  DMD_Monochrome_Parallel::scan_dmd() {
       *datasetreg = (ptr[cnt++]) << 8 ;\
       //*datasetreg = clkmask;
 #else
+	// 8- or 16-bit cell goes to the low half of BSRR as is
 #define pew                    \
       *datasetreg = all_clr_mask;     \
       *datasetreg = ptr[cnt++] ;\
@@ -211,98 +438,166 @@ void  DMD_Monochrome_Parallel::scan_dmd() {
 	}
 
 	*datasetreg = all_clr_mask; // Set clock low
-#endif
-	DEBUG_TIME_MARK;
-	//switch_row();
-	DEBUG_TIME_MARK;
-
 }
+#endif
 /*--------------------------------------------------------------------------------------*/
 void DMD_Monochrome_Parallel::clearScreen(byte bNormal)
 {
-	uint8_t mask;
-#ifdef USE_UPPER_8BIT
-	if (bNormal ^ inverse_ALL_flag) // clear all pixels
-		mask = clk_clrmask_low & 0x00FF;
-	else // set all pixels
-		mask = clkmask_low & 0x00FF;
-#else
-	if (bNormal ^ inverse_ALL_flag) // clear all pixels
-	//	mask = 0x03;
-	mask = clk_clrmask & 0x00FF;
-	
-	else // set all pixels
-		mask = clkmask & 0x00FF;
-#endif
-	
-	memset(bDMDScreenRAM, mask, mem_Buffer_Size);
+	// clear all pixels if bNormal ^ inverse_ALL_flag, otherwise set all
+	fill_cells((ParallelCellType*)bDMDScreenRAM, fill_cell(bNormal ^ inverse_ALL_flag), plane_cells * nPlanes);
 
 }
 /*--------------------------------------------------------------------------------------*/
+void DMD_Monochrome_Parallel::fillScreen(uint16_t color)
+{
+	if (nPlanes == 1) {
+		DMD::fillScreen(color);
+		return;
+	}
+	uint8_t level = gray_level(color);
+	for (uint8_t p = 0; p < nPlanes; p++)
+		fill_cells((ParallelCellType*)bDMDScreenRAM + p * plane_cells, fill_cell(!(level & (1 << p))), plane_cells);
+}
+/*--------------------------------------------------------------------------------------*/
+// Shift entire screen by step pixels, left (step < 0) or right (step > 0)
+// The screen shift follows the rotation, it goes along or across the buffer lines
 void DMD_Monochrome_Parallel::shiftScreen(int8_t step) {
-	uint8_t mask;
-#ifdef USE_UPPER_8BIT
-	if (inverse_ALL_flag)
-		mask = clkmask_low & 0x00FF;
-	else
-		mask = clk_clrmask_low & 0x00FF;
-#else
-	if (inverse_ALL_flag)
-		mask = clkmask & 0x00FF;
-	else
-		mask = clk_clrmask & 0x00FF;
-#endif
-	uint16_t column_cnt = WIDTH / 8;
-
-	if (step < 0) {
-		uint16_t ptr = 0;
-
-		for (byte j = 0; j < 4; j++) {  // mux
-			// columns
-			for (byte k = 0; k < column_cnt;k++) {
-				bool last_column = (k == (column_cnt - 1));
-				// four lines
-				for (byte jj = 0; jj < 4; jj++) {
-					// seven points
-					for (byte i = 0; i < 7;i++) {
-						bDMDScreenRAM[ptr] = bDMDScreenRAM[ptr + 1];
-						ptr++;
+	bool across;
+	step = buffer_shift(step, across);
+	if (across) {
+		uint8_t n = (step < 0) ? -step : step;
+		if (n > HEIGHT) n = HEIGHT;
+		while (n--) shift_buffer_line((step < 0) ? -1 : 1);
+	}
+	else shift_buffer(step);
+}
+/*--------------------------------------------------------------------------------------*/
+// Shift entire screen one line up (step < 0) or down (step > 0)
+void DMD_Monochrome_Parallel::shiftScreenVertical(int8_t step) {
+	if (step == 0) return;
+	bool across;
+	step = buffer_shift((step < 0) ? -1 : 1, across, true);
+	if (across) shift_buffer_line(step);
+	else shift_buffer(step);
+}
+/*--------------------------------------------------------------------------------------*/
+// Shift the buffer lines by step pixels, left (step < 0) or right (step > 0)
+// Every panel line of the mux block is stored as 8-cells column groups,
+// column_size cells apart. Points are moved inside the group by memmove()
+// and the remaining points are carried from the neighbour group.
+// Grayscale planes follow each other, so they are handled as the next mux rows.
+void DMD_Monochrome_Parallel::shift_buffer(int8_t step) {
+	ParallelCellType* bDMDScreenRAM = (ParallelCellType*)this->bDMDScreenRAM;
+	uint8_t bg = bg_level();
+	const uint8_t cs = sizeof(ParallelCellType);
+
+	uint8_t n = (step < 0) ? -step : step;
+	if (n == 0) return;
+	if (n >= WIDTH) {
+		for (uint8_t p = 0; p < nPlanes; p++)
+			fill_cells(bDMDScreenRAM + p * plane_cells, fill_cell(!(bg & (1 << p))), plane_cells);
+		return;
+	}
+	int16_t column_cnt = WIDTH / 8;
+	int16_t col_shift = n / 8;
+	uint8_t r = n % 8;
+
+	for (byte j = 0; j < DMD_MONO_SCAN * nPlanes; j++) {  // mux
+		// zero bit is pixel on
+		ParallelCellType mask = fill_cell(!(bg & (1 << (j / DMD_MONO_SCAN))));
+		for (byte jj = 0; jj < 4; jj++) {  // four lines
+			ParallelCellType* line = bDMDScreenRAM + j * x_len + jj * 8;
+#define GROUP_PTR(k)   (line + (k) * column_size)
+
+			if (step < 0) {
+				for (int16_t k = 0; k < column_cnt; k++) {
+					int16_t src = k + col_shift;
+					if (src < column_cnt) memmove(GROUP_PTR(k), GROUP_PTR(src) + r, (8 - r) * cs);
+					else fill_cells(GROUP_PTR(k), mask, 8 - r);
+					if (r) {
+						if (src + 1 < column_cnt) memcpy(GROUP_PTR(k) + 8 - r, GROUP_PTR(src + 1), r * cs);
+						else fill_cells(GROUP_PTR(k) + 8 - r, mask, r);
 					}
-					// eighth point
-					if (last_column) bDMDScreenRAM[ptr] = mask;
-					else bDMDScreenRAM[ptr] = bDMDScreenRAM[ptr + (column_size - 7)];
-					ptr++;
 				}
 			}
-
-		}
-	}
-
-	else if (step > 0) {
-		uint16_t ptr = mem_Buffer_Size - 1;
-
-		for (byte j = 0; j < 4; j++) {  // mux
-			// columns
-			for (byte k = 0; k < column_cnt;k++) {
-				bool last_column = (k == (column_cnt - 1));
-				// four lines
-				for (byte jj = 0; jj < 4; jj++) {
-					// seven points
-					for (byte i = 0; i < 7;i++) {
-						bDMDScreenRAM[ptr] = bDMDScreenRAM[ptr - 1];
-						ptr--;
+			else {
+				for (int16_t k = column_cnt - 1; k >= 0; k--) {
+					int16_t src = k - col_shift;
+					if (src >= 0) memmove(GROUP_PTR(k) + r, GROUP_PTR(src), (8 - r) * cs);
+					else fill_cells(GROUP_PTR(k) + r, mask, 8 - r);
+					if (r) {
+						if (src > 0) memcpy(GROUP_PTR(k), GROUP_PTR(src - 1) + 8 - r, r * cs);
+						else fill_cells(GROUP_PTR(k), mask, r);
 					}
-					// eighth point
-					if (last_column) bDMDScreenRAM[ptr] = mask;
-					else bDMDScreenRAM[ptr] = bDMDScreenRAM[ptr - (column_size - 7)];
-					ptr--;
 				}
 			}
-
+#undef GROUP_PTR
 		}
 	}
 }
+/*--------------------------------------------------------------------------------------*/
+// Shift the buffer one line up (step < 0) or down (step > 0)
+// Every cell holds the same panel line for all parallel panel rows,
+// so moving lines inside the panel is a copy of 8-cells column group.
+// Only the line, crossed the panel border, requires to move the bit to next panel row.
+void DMD_Monochrome_Parallel::shift_buffer_line(int8_t step) {
+	ParallelCellType* bDMDScreenRAM = (ParallelCellType*)this->bDMDScreenRAM;
+	ParallelCellType clk_bit, row_bits[DMD_PARALLEL_MAX_ROWS];
+	clk_bit = fill_cell(false);
+	for (byte i = 0; i < this->data_pins_cnt; i++) {
+#if (defined(ARDUINO_ARCH_RP2040))
+		row_bits[i] = (1 << i);
+#elif (defined(__STM32F1__) || defined(__STM32F4__))
+		row_bits[i] = port_to_cell(row_mask[i]);
+#endif
+	}
+	uint8_t bg = bg_level();
+	const uint8_t group_bytes = 8 * sizeof(ParallelCellType);
 
+	uint16_t column_cnt = WIDTH / 8;
+	ParallelCellType t[8];
 
+	if (step == 0) return;
 
+	for (uint16_t k = 0; k < column_cnt * nPlanes; k++) {
+		uint8_t p = k / column_cnt;    // grayscale plane
+		// zero bit is pixel on
+		bool bg_off = !(bg & (1 << p));
+		ParallelCellType* col_ptr = bDMDScreenRAM + p * plane_cells + (k % column_cnt) * column_size;
+#define LINE_PTR(ln)   (col_ptr + ((ln) % 4) * x_len + (3 - (ln) / 4) * 8)
 
+		if (step > 0) {
+			memcpy(t, LINE_PTR(DMD_PIXELS_DOWN - 1), group_bytes);
+			for (int8_t ln = DMD_PIXELS_DOWN - 1; ln > 0; ln--) {
+				memcpy(LINE_PTR(ln), LINE_PTR(ln - 1), group_bytes);
+			}
+			// last line of every panel row goes to the first line of the panel row below
+			ParallelCellType* ptr = LINE_PTR(0);
+			for (byte i = 0; i < 8; i++) {
+				ParallelCellType b = clk_bit;
+				if (bg_off) b |= row_bits[0];
+				for (byte j = 1; j < this->data_pins_cnt; j++) {
+					if (t[i] & row_bits[j - 1]) b |= row_bits[j];
+				}
+				ptr[i] = b;
+			}
+		}
+		else {
+			memcpy(t, LINE_PTR(0), group_bytes);
+			for (int8_t ln = 0; ln < DMD_PIXELS_DOWN - 1; ln++) {
+				memcpy(LINE_PTR(ln), LINE_PTR(ln + 1), group_bytes);
+			}
+			// first line of every panel row goes to the last line of the panel row above
+			ParallelCellType* ptr = LINE_PTR(DMD_PIXELS_DOWN - 1);
+			for (byte i = 0; i < 8; i++) {
+				ParallelCellType b = clk_bit;
+				if (bg_off) b |= row_bits[this->data_pins_cnt - 1];
+				for (byte j = 0; j < this->data_pins_cnt - 1; j++) {
+					if (t[i] & row_bits[j + 1]) b |= row_bits[j];
+				}
+				ptr[i] = b;
+			}
+		}
+#undef LINE_PTR
+	}
+}
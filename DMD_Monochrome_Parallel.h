@@ -1,38 +1,157 @@
 #pragma once
 #include "DMD_STM32a.h"
 
+#if (defined(USE_16BIT_PARALLEL) && (defined(__STM32F1__) || defined(__STM32F4__)))
+// every buffer cell is a whole 16-bit GPIO port: CLK + up to 15 rows of panels
+#undef USE_UPPER_8BIT
+typedef uint16_t ParallelCellType;
+#define DMD_PARALLEL_MAX_ROWS 15
+#else
+typedef uint8_t ParallelCellType;
+#define DMD_PARALLEL_MAX_ROWS 8
+#endif
+
+#if (defined(PARALLEL_DMA) && !defined(__STM32F4__))
+#undef PARALLEL_DMA
+#endif
+
 class DMD_Monochrome_Parallel :
 	public DMD
 {
 public:
+	// gray_bits - 1 for monochrome, 2..4 for grayscale, pixel color is the level 0..(2^gray_bits - 1)
+	// panelsHigh - up to DMD_PARALLEL_MAX_ROWS, pinlist holds CLK and a pin for every panel row
 	DMD_Monochrome_Parallel(byte _pin_A, byte _pin_B, byte _pin_nOE, byte _pin_SCLK, uint8_t* pinlist,
-		byte panelsWide, byte panelsHigh, bool d_buf = false, byte dmd_pixel_x = 32, byte dmd_pixel_y = 16);
+		byte panelsWide, byte panelsHigh, bool d_buf = false, byte dmd_pixel_x = 32, byte dmd_pixel_y = 16,
+		uint8_t gray_bits = 1);
 
 	~DMD_Monochrome_Parallel();
 
 	void init(uint16_t scan_interval = 1000) override;
 	void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+	void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+	void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
 	void scan_dmd();
 	void clearScreen(byte bNormal)  override;
+	void fillScreen(uint16_t color) override;
 	void shiftScreen(int8_t step)  override;
+	void shiftScreenVertical(int8_t step)  override;
 
 	// changing connect scheme not allowed for Parallel
 	virtual void setConnectScheme(uint8_t sch) override {} ;
+#if defined(PARALLEL_DMA)
+	// transfer complete of the row data, stops the DMA timer
+	void rowDataDone();
+#endif
 
 protected:
 
 	void set_pin_modes() override;
+	void switch_row() override;
+	void drawHByte(int16_t x, int16_t y, uint8_t hbyte, uint16_t bsize, uint8_t* fg_col_bytes,
+		uint8_t* bg_col_bytes) override;
+	void getColorBytes(uint8_t* cbytes, uint16_t color) override;
+	// draw the run of hbyte bits or solid run (hbyte = 0xff) to the right or down if vertical
+	void draw_line_run(int16_t x, int16_t y, uint8_t hbyte, uint16_t bsize, uint8_t* fg_col_bytes,
+		uint8_t* bg_col_bytes, bool vertical);
+	// shift along the buffer lines by step pixels or across them by one line
+	void shift_buffer(int8_t step);
+	void shift_buffer_line(int8_t step);
+#if defined(PARALLEL_DMA)
+	void initialize_timers(voidFuncPtr handler) override;
+#elif (defined(__STM32F1__) || defined(__STM32F4__))
+	void send_row(ParallelCellType* ptr);
+#endif
+	// time to send the data of a row, in uS
+	uint32_t row_send_time();
 
 private:
 
 	const uint8_t column_size = 8 * DMD_MONO_SCAN;
+
+	// every panel row takes a bit of the buffer cell, the rows above the limit are dropped
+	static byte limit_rows(byte panelsHigh) {
+		return (panelsHigh > DMD_PARALLEL_MAX_ROWS) ? DMD_PARALLEL_MAX_ROWS : panelsHigh;
+	}
+
+	// Grayscale: every bit of the pixel level is stored in its own plane
+	// and the plane is shown 1:2:4:8 time units (binary code modulation)
+	uint8_t nPlanes = 1;
+	uint8_t gray_max = 1;
+	volatile uint8_t plane = 0;
+	uint16_t plane_cells;       // buffer cells of one plane
+#if defined(PARALLEL_DMA)
+	// DMA_TIMER clocks, one cell is sent in every period
+	const uint8_t dma_cell_period = 14;
+#elif (defined(ARDUINO_ARCH_RP2040))
+	const uint8_t transfer64cells_time = 3;   // in uS
+#endif
+	// level of the color as stored in the planes, bit p goes to the plane p
+	uint8_t gray_level(uint16_t color) {
+		uint8_t level = (color > gray_max) ? gray_max : color;
+		return inverse_ALL_flag ? (gray_max - level) : level;
+	}
+	uint8_t pixel_level(uint16_t color) {
+		if (nPlanes == 1) return ((uint8_t)(color ^ inverse_ALL_flag) == true) ? 1 : 0;
+		return gray_level(color);
+	}
+	uint8_t bg_level() {
+		return pixel_level(textbgcolor);
+	}
+
+	// buffer cell of the pixel and the bit of its panel row in the cell
+	ParallelCellType* pixel_cell(int16_t bX, int16_t bY, ParallelCellType& lookup) {
+		byte panel_row = bY / DMD_PIXELS_DOWN;
+		byte panel_bY = bY % DMD_PIXELS_DOWN;
+#if (defined(ARDUINO_ARCH_RP2040))
+		lookup = (1 << panel_row);
+#elif (defined(__STM32F1__) || defined(__STM32F4__))	
+		lookup = port_to_cell(row_mask[panel_row]);
+#endif
+		return (ParallelCellType*)bDMDScreenRAM + (panel_bY % 4) * x_len + (bX / 8) * column_size +
+			(3 - panel_bY / 4) * 8 + bX % 8;
+	}
+	// write the pixel level to all planes of the cell, bit by bit with raster operation
+	void write_cell(ParallelCellType* cell, ParallelCellType lookup, uint8_t level, const DMD_RasterOp& rop) {
+		for (uint8_t p = 0; p < nPlanes; p++) {
+			// zero bit is pixel on
+			*cell = ~rop.apply((ParallelCellType)~*cell, (level & (1 << p)) ? lookup : 0, lookup);
+			cell += plane_cells;
+		}
+	}
  
 #if (defined(__STM32F1__) || defined(__STM32F4__))
+		PortType row_mask[DMD_PARALLEL_MAX_ROWS];
+#endif
+
+#if defined(PARALLEL_DMA)
+	const timer_dev* DMA_TIMER = TIMER1;
+	timer_adv_reg_map* DMA_TIMER_BASE = TIMER1_BASE;
+	const dma_dev* parDmaDev = DMA2;
+	dma_channel  DmaDataChannel = DMA_CH6;
+	dma_channel  DmaClkChannel = DMA_CH6;
+	dma_stream  datTxDmaStream = DMA_STREAM1; // TIM1 CH1
+	dma_stream  clkTxDmaStream = DMA_STREAM6; // TIM1 CH3 
+	// CLK and DATA reset word, written to BSRR before every cell
+	PortType dma_clr_mask;
+#endif
+
+	// port bits as they are stored in the buffer cell
+	ParallelCellType port_to_cell(PortType mask) {
 #ifdef USE_UPPER_8BIT
-	PortType clk_clrmask_low, clkmask_low;
-#endif // USE_UPPER_8BIT
-		PortType row_mask[8];
+		return (ParallelCellType)(mask >> 8);
+#else
+		return (ParallelCellType)mask;
 #endif
+	}
+	// cell with all panel rows off (or on), CLK bit is always set
+	ParallelCellType fill_cell(bool all_off) {
+		return all_off ? port_to_cell(clk_clrmask) : port_to_cell(clkmask);
+	}
+	void fill_cells(ParallelCellType* ptr, ParallelCellType val, uint16_t cnt) {
+		if (sizeof(ParallelCellType) == 1) memset(ptr, val, cnt);
+		else while (cnt--) *ptr++ = val;
+	}
 
 	
 };
@@ -7,6 +7,7 @@
  Dmitry Dmitriev (c) 2019-2023
  /--------------------------------------------------------------------------------------*/
 #include "DMD_RGB.h"
+#include "DMD_RGB_Layer.h"
 
 static volatile DMD_RGB_BASE* running_dmd_R;
 void inline __attribute__((always_inline)) scan_running_dmd_R()
@@ -15,6 +16,12 @@ void inline __attribute__((always_inline)) scan_running_dmd_R()
 	DMD_RGB_BASE* next = (DMD_RGB_BASE*)running_dmd_R;
 	next->scan_dmd();
 }
+// transfer complete of the circular DMA, that switches the rows
+void frame_running_dmd_R()
+{
+	DMD_RGB_BASE* next = (DMD_RGB_BASE*)running_dmd_R;
+	next->frameDone();
+}
 
 #ifndef _swap_int16_t
 #define _swap_int16_t(a, b) { int16_t t = a; a = b; b = t; }
@@ -27,6 +34,7 @@ DMD_RGB_BASE::DMD_RGB_BASE(byte mux_cnt, uint8_t* mux_list, byte _pin_nOE, byte
 {
 
 	fast_Hbyte = true;
+	connect_shift = true;
 	rgbpins = data_pins;
 	running_dmd_R = this;
 	OE_polarity = OE_PWM_NEGATIVE;
@@ -93,6 +101,9 @@ void DMD_RGB_BASE::setCycleLen()  {
 #endif
 	if (this->scan_cycle_len < write_time) this->scan_cycle_len = write_time;
 
+	// every row is shown for scan_cycle_len << (nPlanes - 1) in all
+	this->frame_rate = (CYCLES_PER_MICROSECOND * 1000000ul) / ((this->scan_cycle_len * this->nRows) << (this->nPlanes - 1));
+	if (this->frame_rate == 0) this->frame_rate = 1;
 }
 
 /*--------------------------------------------------------------------------------------*/
@@ -269,13 +280,25 @@ void DMD_RGB_BASE::scan_dmd_p1() {
 		plane = 0;                  // Yes, reset to plane 0, and
 		if (++row >= nRows) {        // advance row counter.  Maxed out?
 			row = 0;              // Yes, reset row counter, then...
+			frame_count++;
 			if (swapflag == true) {    // Swap front/back buffers if requested
 				backindex = 1 - backindex;
 				swapflag = false;
 				}
 			}
 		buffptr = matrixbuff[1 - backindex]; // Reset into front buffer
-		buffptr += row * x_len;
+		if (scroll_y) {
+			// the line of the lower half is shown in the upper half and vice versa
+			uint8_t line = row + scroll_y;
+			if (line >= DMD_PIXELS_DOWN) line -= DMD_PIXELS_DOWN;
+			row_swapped = (line >= pol_displ);
+			if (row_swapped) line -= pol_displ;
+			buffptr += line * x_len;
+		}
+		else {
+			row_swapped = false;
+			buffptr += row * x_len;
+		}
 		}
 
 	// For 4bit Color set mux at 1st Plane
@@ -364,11 +387,42 @@ void DMD_RGB_BASE::scan_dmd_p3() {
       *datasetreg = clk_clrmask;     \
       *datasetreg = expand[*ptr++];
 #endif
-	for (uint16_t uu = 0; uu < x_len; uu += 8)
-	{
-		// Loop is unrolled for speed:
-		pew pew pew pew pew pew pew pew
+	if (scroll_x || scroll_y) {
+		// every row of panels from the column scroll_x, wrapping around
+#if defined (DIRECT_OUTPUT)
+#define pew_scroll                    \
+      *datasetreg = clk_clrmask;     \
+      *datasetreg = *ptr++;
+#else
+		const uint16_t* table = row_swapped ? expand_swap : expand;
+#define pew_scroll                    \
+      *datasetreg = clk_clrmask;     \
+      *datasetreg = table[*ptr++];
+#endif
+		// two contiguous parts of the row, unrolled as the plain loop
+#define pew_scroll_run(len)                \
+      for (uu = (len); uu >= 8; uu -= 8) { \
+        pew_scroll pew_scroll pew_scroll pew_scroll \
+        pew_scroll pew_scroll pew_scroll pew_scroll \
+      }                                    \
+      for (; uu > 0; uu--) { pew_scroll }
+		uint16_t uu;
+		for (uint16_t seg = 0; seg < x_len; seg += WIDTH) {
+			ptr = buffptr + seg + scroll_x;
+			pew_scroll_run(WIDTH - scroll_x)
+			ptr = buffptr + seg;
+			pew_scroll_run(scroll_x)
+		}
+#undef pew_scroll_run
+#undef pew_scroll
+	}
+	else {
+		for (uint16_t uu = 0; uu < x_len; uu += 8)
+		{
+			// Loop is unrolled for speed:
+			pew pew pew pew pew pew pew pew
 
+		}
 	}
 
 	*datasetreg = clkmask << 16; // Set clock low
@@ -385,8 +439,6 @@ void DMD_RGB_BASE::scan_dmd_p3() {
 #endif
 /*--------------------------------------------------------------------------------------*/
 void DMD_RGB_BASE::drawPixel(int16_t x, int16_t y, uint16_t c)  {
-	uint8_t r, g, b, bit, limit, * ptr;
-
 
 	DEBUG_TIME_MARK_333;
 	DEBUG_TIME_MARK;
@@ -398,121 +450,404 @@ void DMD_RGB_BASE::drawPixel(int16_t x, int16_t y, uint16_t c)  {
 
 	// transform X & Y for Rotate and connect scheme
 
-		// Adafruit_GFX uses 16-bit color in 5/6/5 format, while matrix needs
-		// 4/4/4.  Pluck out relevant bits while separating into R,G,B:
-	r = c >> 12;        // RRRRrggggggbbbbb
-	g = (c >> 7) & 0xF; // rrrrrGGGGggbbbbb
-	b = (c >> 1) & 0xF; // rrrrrggggggBBBBb
-
 	uint16_t base_addr = get_base_addr(x, y);
-	ptr = &matrixbuff[backindex][base_addr]; // Base addr
-	DEBUG_TIME_MARK;
-
-
-	bit = 1;
-	limit = 1 << nPlanes;
-	if (y % DMD_PIXELS_DOWN < pol_displ) {
-		// Data for the upper half of the display is stored in the lower
-		// bits of each byte.
-	
-		// Data is stored in the low 6 bits so it can be quickly
-		// copied to the DATAPORT register w/6 output lines.
-		for (; bit < limit; bit <<= 1) {
+	uint8_t* ptr = &matrixbuff[backindex][base_addr]; // Base addr
 
-			*ptr |= output_mask;
+	// color bytes come from the cache of getColorBytes(),
+	// so every plane is one masked read-modify-write
+	uint8_t col_bytes[4];
+	getColorBytes(col_bytes, c);
+	const uint8_t* mask = getColorByteMask(y % DMD_PIXELS_DOWN >= pol_displ);
 
-			* ptr &= ~B000111;            // Mask out R,G,B in one op
-			if (r & bit) *ptr |= B000001; // Plane N R: bit 2
-			if (g & bit) *ptr |= B000010; // Plane N G: bit 3
-			if (b & bit) *ptr |= B000100; // Plane N B: bit 4
-			ptr += displ_len;                 // Advance to next bit plane
+	DEBUG_TIME_MARK;
+	if (graph_mode == GRAPHICS_NORMAL || graph_mode == GRAPHICS_NOR) {
+		for (uint8_t i = 0; i < col_bytes_cnt; i++) {
+			*ptr = output_mask | (*ptr & ~mask[i]) | (col_bytes[i] & mask[i]);
+			ptr += displ_len;
 		}
 	}
 	else {
-		// Data for the lower half of the display is stored in the upper
-		// bits
-
-		for (; bit < limit; bit <<= 1) {
-
-			*ptr |= output_mask;
-
-			* ptr &= ~B111000;            // Mask out R,G,B in one op
-			if (r & bit) *ptr |= B001000; // Plane N R: bit 5
-			if (g & bit) *ptr |= B010000; // Plane N G: bit 6
-			if (b & bit) *ptr |= B100000; // Plane N B: bit 7
-			ptr += displ_len;                 // Advance to next bit plane
+		// raster operations on the plane bits of the color
+		DMD_RasterOp rop = get_raster_op(graph_mode);
+		for (uint8_t i = 0; i < col_bytes_cnt; i++) {
+			*ptr = output_mask | rop.apply(*ptr, col_bytes[i], mask[i]);
+			ptr += displ_len;
 		}
 	}
 	DEBUG_TIME_MARK;
 
 }
 /*--------------------------------------------------------------------------------------*/
-void DMD_RGB_BASE::drawHByte(int16_t x, int16_t y, uint8_t hbyte, uint16_t bsize, uint8_t* fg_col_bytes,
-	uint8_t* bg_col_bytes) {
+// Batch of points of one color: the color bytes, masks and raster operation
+// are prepared once for all points
+void DMD_RGB_BASE::drawPixels(const int16_t* xy, uint16_t count, uint16_t c) {
 
-	
-	static uint8_t ColorByteMask[] = { B000111 , B111000 };
-	if ((hbyte != 0xff)&& (bsize > 8)) bsize = 8;
-	
-		//if whole line is outside - go out
-	if (((x + bsize) <= 0) || (x >= WIDTH) || (y < 0) || (y >= HEIGHT)) return;
+	if (graph_mode == GRAPHICS_NOR) {
+		if (c == textcolor) c = textbgcolor;
+		else return;
+	}
+	uint8_t col_bytes[4];
+	getColorBytes(col_bytes, c);
+	const uint8_t* masks[2] = { getColorByteMask(false), getColorByteMask(true) };
+	DMD_RasterOp rop = get_raster_op((graph_mode == GRAPHICS_NOR) ? GRAPHICS_NORMAL : graph_mode);
+	uint8_t* buff = matrixbuff[backindex];
+
+	for (; count > 0; count--, xy += 2) {
+		int16_t x = xy[0], y = xy[1];
+		if ((x < 0) || (x >= _width) || (y < 0) || (y >= _height)) continue;
+
+		uint8_t* ptr = buff + get_base_addr(x, y);
+		const uint8_t* mask = masks[(y % DMD_PIXELS_DOWN) >= pol_displ];
+		for (uint8_t i = 0; i < col_bytes_cnt; i++) {
+			*ptr = output_mask | rop.apply(*ptr, col_bytes[i], mask[i]);
+			ptr += displ_len;
+		}
+	}
+}
+/*--------------------------------------------------------------------------------------*/
+// Line of an image: the pixels are converted to the color bytes one by one
+// and written by the runs of the buffer, as draw_line_run() does
+void DMD_RGB_BASE::drawLine888(int16_t x, int16_t y, const uint8_t* rgb, uint16_t w) {
 
-	//if start of line before 0 - draw portion of line from x=0
+	if ((y < 0) || (y >= _height) || (x >= _width)) return;
 	if (x < 0) {
-		bsize = bsize + x;
-		if (hbyte != 0xff) hbyte <<= (x * -1);
+		if (w <= -x) return;
+		rgb += -x * 3;
+		w += x;
 		x = 0;
 	}
+	if (w > _width - x) w = _width - x;
+
+	DMD_RasterOp rop = get_raster_op((graph_mode == GRAPHICS_NOR) ? GRAPHICS_NORMAL : graph_mode);
+	uint8_t* buff = matrixbuff[backindex];
+	uint8_t col_bytes[4];
+
+	while (w > 0) {
+		uint16_t addr;
+		int16_t step;
+		bool lower;
+		uint16_t n = get_line_run(x, y, w, addr, step, lower, false);
+		const uint8_t* mask = getColorByteMask(lower);
+		uint8_t* ptr_base = buff + addr;
+
+		for (uint16_t j = 0; j < n; j++) {
+			getColorBytes(col_bytes, color888_at(x + j, y, rgb));
+			rgb += 3;
+			uint8_t* ptr = ptr_base;
+			for (uint8_t b = 0; b < col_bytes_cnt; b++) {
+				*ptr = output_mask | rop.apply(*ptr, col_bytes[b], mask[b]);
+				ptr += displ_len;
+			}
+			ptr_base += step;
+		}
+		x += n;
+		w -= n;
+	}
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_BASE::drawBitmap888(int16_t x, int16_t y, const uint8_t* rgb, int16_t w, int16_t h) {
 
-	//if end of line after right edge of screen - draw until WIDTH-1
-	if ((x + bsize) > WIDTH) bsize = WIDTH - x;
+	if (w <= 0) return;
+	for (int16_t j = 0; j < h; j++) {
+		drawLine888(x, y + j, rgb, w);
+		rgb += w * 3;
+	}
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_BASE::drawPixel888(int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b) {
 
-	// transform X & Y for Rotate and connect scheme
+	uint8_t rgb[3] = { r, g, b };
+	drawPixel(x, y, color888_at(x, y, rgb));
+}
+/*--------------------------------------------------------------------------------------*/
+bool DMD_RGB_BASE::setDither(bool on) {
 
-	uint16_t base_addr = get_base_addr(x, y);
-	uint8_t* ptr_base = &matrixbuff[backindex][base_addr]; // Base addr
+	if (!on) {
+		free(dither_table);
+		dither_table = NULL;
+		return true;
+	}
+	if (dither_table == NULL) {
+		dither_table = (uint8_t*)malloc(256);
+		if (dither_table == NULL) return false;
+	}
+	// levels of the plane depth, the color bytes are made from 4/4/4
+	uint8_t levels = (1 << nPlanes) - 1;
+	dither_step = 15 / levels;
+	for (uint16_t v = 0; v < 256; v++) {
+		uint16_t n = v * levels;
+		dither_table[v] = (((n / 255) * dither_step) << 4) | (((n % 255) * 16) / 255);
+	}
+	return true;
+}
+/*--------------------------------------------------------------------------------------*/
+// The channel goes to the next level if its fraction is above the threshold
+// of the position, so the average of the area is the 8-bit value
+uint16_t DMD_RGB_BASE::color888_at(int16_t x, int16_t y, const uint8_t* rgb) {
+
+	static const uint8_t bayer4[4][4] = {
+		{  0,  8,  2, 10 },
+		{ 12,  4, 14,  6 },
+		{  3, 11,  1,  9 },
+		{ 15,  7, 13,  5 }
+	};
+	if (dither_table == NULL) return Color888(rgb[0], rgb[1], rgb[2]);
+
+	uint8_t t = bayer4[y & 3][x & 3];
+	uint8_t c[3];
+	for (uint8_t i = 0; i < 3; i++) {
+		uint8_t d = dither_table[rgb[i]];
+		c[i] = (d >> 4) + (((d & 0x0F) > t) ? dither_step : 0);
+	}
+	return Color444(c[0], c[1], c[2]);
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_BASE::drawHByte(int16_t x, int16_t y, uint8_t hbyte, uint16_t bsize, uint8_t* fg_col_bytes,
+	uint8_t* bg_col_bytes) {
+
+	draw_line_run(x, y, hbyte, bsize, fg_col_bytes, bg_col_bytes, false);
+}
+/*--------------------------------------------------------------------------------------*/
+// The run is written by parts, lying at the bytes with equal step in the buffer:
+// the part of the line goes right or left along the buffer line, or up and down
+// across the lines if the screen is rotated by 90 degrees.
+// Without bg_col_bytes the zero bits are transparent.
+void DMD_RGB_BASE::draw_line_run(int16_t x, int16_t y, uint8_t hbyte, uint16_t bsize, uint8_t* fg_col_bytes,
+	uint8_t* bg_col_bytes, bool vertical) {
+
+	if (!clip_run(x, y, hbyte, bsize, vertical)) return;
 
 	DEBUG_TIME_MARK;
-	uint8_t* mask_ptr, * mask;
-	uint8_t* col_bytes;
-	uint8_t* ptr = ptr_base;
-	if (y % DMD_PIXELS_DOWN < pol_displ) {
-		mask = ColorByteMask;
+	// GRAPHICS_NOR of RGB classes is handled in drawPixel only
+	DMD_RasterOp rop = get_raster_op((graph_mode == GRAPHICS_NOR) ? GRAPHICS_NORMAL : graph_mode);
+	uint8_t* buff = matrixbuff[backindex];
+	uint8_t* col_bytes = fg_col_bytes;
+
+	while (bsize > 0) {
+		uint16_t addr;
+		int16_t step;
+		bool lower;
+		uint16_t n = get_line_run(x, y, bsize, addr, step, lower, vertical);
+		const uint8_t* mask = getColorByteMask(lower);
+		uint8_t* ptr_base = buff + addr;
+
+		for (uint16_t j = 0; j < n; j++) {
+			if (hbyte != 0xff) {
+				col_bytes = (hbyte & 0x80) ? fg_col_bytes : bg_col_bytes;
+				hbyte <<= 1;
+			}
+			uint8_t* ptr = ptr_base;
+			ptr_base += step;
+			if (col_bytes == NULL) continue;
+			for (uint8_t b = 0; b < col_bytes_cnt; b++) {
+				*ptr = output_mask | rop.apply(*ptr, col_bytes[b], mask[b]);
+				ptr += displ_len;
+			}
+		}
+		if (vertical) y += n;
+		else x += n;
+		bsize -= n;
+	}
+	DEBUG_TIME_MARK;
+}
+/*--------------------------------------------------------------------------------------*/
+// With plain pattern (multiplex = 1) the whole buffer line is consecutive bytes
+// and the lines of the half of the panel follow with equal step,
+// other patterns keep consecutive only 8 pixels of the line.
+uint16_t DMD_RGB_BASE::get_line_run(int16_t x, int16_t y, uint16_t len, uint16_t& addr, int16_t& step, bool& lower,
+	bool vertical) {
+
+	int16_t bx = x, by = y;
+	addr = get_base_addr(bx, by);
+	lower = (by % DMD_PIXELS_DOWN) >= pol_displ;
+	step = 1;
+	if ((len < 2) || (!fast_Hbyte)) return 1;
+
+	// get_base_addr() of some templates changes x beyond the transform
+	bx = x;
+	by = y;
+	transform_XY(bx, by);
+	uint8_t dir;
+	uint16_t run = line_run(bx, by, dir, vertical);
+	if (dir & 1) {
+		if (multiplex != 1) return 1;
+		uint8_t pol_y = by % pol_displ;
+		uint16_t half_run = (dir == 1) ? pol_displ - pol_y : pol_y + 1;
+		if (run > half_run) run = half_run;
 	}
-	else {
+	else if (multiplex != 1) {
+		uint16_t group_run = (dir == 0) ? 8 - bx % 8 : bx % 8 + 1;
+		if (run > group_run) run = group_run;
+	}
+	if (run > len) run = len;
 
-		mask = ColorByteMask + 1;
+	if (run > 1) {
+		bx = x + !vertical;
+		by = y + vertical;
+		step = (int16_t)(get_base_addr(bx, by) - addr);
 	}
-	col_bytes = fg_col_bytes;
-	for (uint8_t j = 0; j < bsize; j++) {
-		if (hbyte != 0xff) {
-			if (hbyte & 0x80) {
-				col_bytes = fg_col_bytes;
-			}
-			else {
-				col_bytes = bg_col_bytes;
-			}
-			hbyte <<= 1;
+	return run;
+}
+/*--------------------------------------------------------------------------------------*/
+// Source and destination runs are cut to the same length
+void DMD_RGB_BASE::move_line(uint8_t* dst_buf, int16_t xd, int16_t yd, const uint8_t* src_buf, int16_t xs, int16_t ys,
+	uint16_t len, bool vertical) {
+
+	while (len > 0) {
+		uint16_t dst_addr, src_addr;
+		int16_t dst_step, src_step;
+		bool dst_lower, src_lower;
+		uint16_t run = get_line_run(xd, yd, len, dst_addr, dst_step, dst_lower, vertical);
+		run = get_line_run(xs, ys, run, src_addr, src_step, src_lower, vertical);
+		move_pixels(dst_buf + dst_addr, src_buf + src_addr, run, dst_lower, src_lower, dst_step, src_step);
+		if (vertical) {
+			yd += run;
+			ys += run;
 		}
-		ptr = ptr_base + j;
-		mask_ptr = mask;
-		for (uint8_t b = 0; b < col_bytes_cnt; b++)
-		{
-			*ptr &= ~(*mask_ptr);
+		else {
+			xd += run;
+			xs += run;
+		}
+		len -= run;
+	}
+}
+/*--------------------------------------------------------------------------------------*/
+const uint8_t* DMD_RGB_BASE::getColorByteMask(bool lower_half) {
 
-			*ptr |= output_mask | (col_bytes[b] & (*mask_ptr));
+	static const uint8_t ColorByteMask[] = { B000111 , B000111 , B000111 , B000111 ,
+											 B111000 , B111000 , B111000 , B111000 };
+	return lower_half ? ColorByteMask + 4 : ColorByteMask;
+}
+/*--------------------------------------------------------------------------------------*/
+bool DMD_RGB_BASE::scan_offset_supported() {
+#if (defined(__STM32F1__) || defined(__STM32F4__)) && !defined(RGB_DMA)
+	return (multiplex == 1) && fast_Hbyte;
+#else
+	return false;
+#endif
+}
+/*--------------------------------------------------------------------------------------*/
+bool DMD_RGB_BASE::setScrollOffset(int16_t x, int16_t y) {
 
+	if (!scan_offset_supported()) return false;
+	x %= (int16_t)WIDTH;
+	if (x < 0) x += WIDTH;
+	y %= (int16_t)DMD_PIXELS_DOWN;
+	if (y < 0) y += DMD_PIXELS_DOWN;
 
-			ptr += displ_len;
+#if (defined(__STM32F1__) || defined(__STM32F4__))
+	if (y) {
+		// lines would wrap inside every row of panels instead of the whole screen
+		if (DisplaysHigh > 1) return false;
+#if defined (DIRECT_OUTPUT)
+		return false;
+#else
+		// upper and lower halves are swapped by the table, bits of 6 data pins only
+		if (expand_swap == NULL) {
+			expand_swap = (uint16_t*)malloc(256 * sizeof(uint16_t));
+			if (expand_swap == NULL) return false;
+			for (uint16_t i = 0; i < 256; i++) {
+				expand_swap[i] = expand[(i & 0xC0) | ((i & 0x07) << 3) | ((i >> 3) & 0x07)];
+			}
 		}
-
+#endif
 	}
-	DEBUG_TIME_MARK;
+#endif
+	scroll_x = x;
+	scroll_y = y;
+	return true;
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_BASE::saveBackground() {
 
+	if (bg_buff == NULL) bg_buff = (uint8_t*)malloc(mem_Buffer_Size);
+	memcpy(bg_buff, matrixbuff[backindex], mem_Buffer_Size);
+	bg_refresh = (matrixbuff[0] != matrixbuff[1]);
+	for (DMD_RGB_Layer* l = layers; l != NULL; l = l->next) l->mark_dirty(0, 0, l->w, l->h);
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_BASE::addLayer(DMD_RGB_Layer* layer) {
+
+	// new layer goes on top
+	DMD_RGB_Layer** last = &layers;
+	while (*last != NULL) last = &(*last)->next;
+	*last = layer;
+	layer->next = NULL;
+	layer->mark_dirty(0, 0, layer->w, layer->h);
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_BASE::swapBuffers(boolean copy) {
+
+	compose_layers();
+	DMD::swapBuffers(copy);
+	if (bg_refresh) {
+		bg_refresh = false;
+		if (!copy) {
+			memcpy(matrixbuff[backindex], bg_buff, mem_Buffer_Size);
+			for (DMD_RGB_Layer* l = layers; l != NULL; l = l->next) l->mark_dirty(0, 0, l->w, l->h);
+		}
+	}
+}
+/*--------------------------------------------------------------------------------------*/
+// Restore the background in the changed rectangles of all layers
+// and then draw every layer clipped by these rectangles, in order from bottom to top.
+// With double buffer the rectangles merged to the other buffer at previous swap are
+// added, because the back buffer doesn't have them yet.
+void DMD_RGB_BASE::compose_layers() {
+
+	if (layers == NULL) return;
+	bool both_buffers = (matrixbuff[0] != matrixbuff[1]);
+	DMD_Rect r;
+	DMD_RGB_Layer* l;
+
+	for (l = layers; l != NULL; l = l->next) {
+		l->get_update_rect(r, both_buffers);
+		if (!r.isEmpty()) restore_background(r.x0, r.y0, r.x1, r.y1);
+	}
+	for (l = layers; l != NULL; l = l->next) {
+		l->get_update_rect(r, both_buffers);
+		if (r.isEmpty()) continue;
+		for (DMD_RGB_Layer* m = layers; m != NULL; m = m->next) m->blit(r);
+	}
+	for (l = layers; l != NULL; l = l->next) {
+		l->prev_dirty = l->dirty;
+		l->dirty.clear();
+	}
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_BASE::restore_background(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+
+	if (x0 < 0) x0 = 0;
+	if (y0 < 0) y0 = 0;
+	if (x1 > _width) x1 = _width;
+	if (y1 > _height) y1 = _height;
+	uint8_t* buff = matrixbuff[backindex];
+
+	for (int16_t y = y0; y < y1; y++) {
+		for (int16_t x = x0; x < x1; ) {
+			uint16_t addr;
+			int16_t step;
+			bool lower;
+			uint16_t n = get_line_run(x, y, x1 - x, addr, step, lower);
+			const uint8_t* mask = getColorByteMask(lower);
+			x += n;
+
+			for (; n > 0; n--, addr += step) {
+				uint8_t* p = buff + addr;
+				uint8_t* src = (bg_buff == NULL) ? NULL : bg_buff + addr;
+				for (uint8_t b = 0; b < col_bytes_cnt; b++) {
+					// without saved background the layers are over black screen
+					*p = (*p & ~mask[b]) | ((src == NULL) ? 0 : (*src & mask[b]));
+					p += displ_len;
+					if (src) src += displ_len;
+				}
+			}
+		}
+	}
 }
 /*--------------------------------------------------------------------------------------*/
 void DMD_RGB_BASE::getColorBytes(uint8_t* cbytes, uint16_t color) {
-	uint8_t r, g, b, bit, limit;
+	uint8_t r, g, b;
 	uint8_t* ptr;
 
 	uint8_t empty_col = output_mask;
@@ -533,7 +868,6 @@ void DMD_RGB_BASE::getColorBytes(uint8_t* cbytes, uint16_t color) {
 	// new color
 	ptr = col_cache + last_color * col_bytes_cnt;
 	colors[last_color] = color;
-	memset(ptr, empty_col, col_bytes_cnt);
 
 
 	// Adafruit_GFX uses 16-bit color in 5/6/5 format, while matrix needs
@@ -545,17 +879,11 @@ void DMD_RGB_BASE::getColorBytes(uint8_t* cbytes, uint16_t color) {
 	b = (c >> 1) & 0xF; // rrrrrggggggBBBBb
 
 
-	limit = 1 << nPlanes;
-	bit = 1;
-	for (; bit < limit; bit <<= 1) {
-		// Mask out R,G,B in one op
-		if (r & bit) *ptr |= B00001001; // Plane N R: bit 2
-		if (g & bit) *ptr |= B00010010; // Plane N G: bit 3
-		if (b & bit) *ptr |= B00100100; // Plane N B: bit 4
-
-		ptr++;                 // Advance to next bit plane
+	// R,G,B bits of the plane for both halves of the panel
+	for (uint8_t p = 0; p < col_bytes_cnt; p++) {
+		ptr[p] = empty_col | (((r >> p) & 1) * B00001001) | (((g >> p) & 1) * B00010010) |
+			(((b >> p) & 1) * B00100100);
 	}
-	ptr -= col_bytes_cnt;
 	memcpy(cbytes, ptr, col_bytes_cnt); return;
 }
 /*--------------------------------------------------------------------------------------*/
@@ -586,37 +914,115 @@ void DMD_RGB_BASE::clearScreen(byte bNormal)  {
 	fillScreen(0x0000);
 }
 /*--------------------------------------------------------------------------------------*/
+// Shift entire screen by step pixels, left (step < 0) or right (step > 0)
+// If the screen lines go along the buffer lines, each WIDTH bytes of the buffer
+// hold one line of the plane, so lines are moved with memmove() and emptied
+// columns are filled with background color bytes of the plane.
+// If the screen is rotated by 90 degrees, the screen columns are the buffer lines,
+// so the columns are moved as a whole, as well as with the tiling map.
 void DMD_RGB_BASE::shiftScreen(int8_t step) {
 	uint8_t* ptr = matrixbuff[backindex];
-	uint8_t mm = output_mask;
-	
-	if (step < 0) {
+	uint8_t n = (step < 0) ? -step : step;
 
-		for (uint16_t i = 0; i < mem_Buffer_Size;i++) {
-			if ((i % WIDTH) == (WIDTH - 1)) {
-				ptr[i] = mm;
-			}
-			else {
-				ptr[i] = ptr[i + 1];
-			}
+	if (n == 0) return;
+	if (n >= _width) {
+		fillScreen(textbgcolor);
+		return;
+	}
+	// the buffer lines are the screen lines only in plain pattern,
+	// otherwise the pixels are moved by columns
+	if ((rotation & 1) || (connectScheme == CONNECT_TILEMAP) || (multiplex != 1) || (!fast_Hbyte)) {
+		if (step < 0) {
+			for (int16_t x = 0; x < _width - n; x++) move_line(ptr, x, 0, ptr, x + n, 0, _height, true);
+			fillRect(_width - n, 0, n, _height, textbgcolor);
+		}
+		else {
+			for (int16_t x = _width - 1; x >= n; x--) move_line(ptr, x, 0, ptr, x - n, 0, _height, true);
+			fillRect(0, 0, n, _height, textbgcolor);
 		}
-		drawFastVLine(WIDTH - 1, 0, HEIGHT, textbgcolor);
+		return;
 	}
-	else if (step > 0) {
-		for (uint16_t i = (mem_Buffer_Size)-1; i > 0;i--) {
-			if ((i % WIDTH) == 0) {
-				ptr[i] = mm;
-			}
-			else {
-				ptr[i] = ptr[i - 1];
+
+	uint16_t keep = WIDTH - n;
+	uint8_t bg_col_bytes[4];
+	getColorBytes(bg_col_bytes, textbgcolor);
+
+	// every panel row takes WIDTH bytes of each buffer line, the place and the direction
+	// (rotation by 180 degrees, odd rows of zigzag) are found by the addresses of its first pixels
+	for (uint8_t r = 0; r < DisplaysHigh; r++) {
+		int16_t x0 = 0, y0 = r * DMD_PIXELS_DOWN;
+		int16_t x1 = 1, y1 = y0;
+		uint16_t addr0 = get_base_addr(x0, y0);
+		uint16_t addr1 = get_base_addr(x1, y1);
+		bool left = ((step < 0) == (addr1 > addr0));
+		uint8_t* line = ptr + (addr0 % x_len) / WIDTH * WIDTH;
+
+		for (uint8_t b = 0; b < col_bytes_cnt; b++) {
+			uint8_t bg = output_mask | bg_col_bytes[b];
+
+			for (uint16_t l = 0; l < pol_displ; l++) {
+				uint8_t* p = line + b * displ_len + l * x_len;
+				if (left) {
+					memmove(p, p + n, keep);
+					memset(p + keep, bg, n);
+				}
+				else {
+					memmove(p + n, p, keep);
+					memset(p, bg, n);
+				}
 			}
 		}
-		ptr[0] = mm;
-		drawFastVLine(0, 0, HEIGHT, textbgcolor);
 	}
 }
 
+/*--------------------------------------------------------------------------------------*/
+// Shift entire screen one line up (step < 0) or down (step > 0)
+// Lines are copied by the runs of get_line_run(), so it works with any template
+// and rotation, the lines of the screen rotated by 90 degrees are the buffer columns
+void DMD_RGB_BASE::shiftScreenVertical(int8_t step) {
+	uint8_t* buff = matrixbuff[backindex];
+	int8_t dir;
+	int16_t y_first, y_last;
+
+	if (step < 0) {
+		dir = -1; y_first = 0; y_last = _height - 1;
+	}
+	else if (step > 0) {
+		dir = 1; y_first = _height - 1; y_last = 0;
+	}
+	else return;
 
+	// go against the shift direction, so each source line is read before it is overwritten
+	for (int16_t y = y_first; y != y_last; y -= dir) {
+		move_line(buff, 0, y, buff, 0, y - dir, _width);
+	}
+	// fill the line came in with background
+	drawFastHLine(0, y_last, _width, textbgcolor);
+}
+/*--------------------------------------------------------------------------------------*/
+// Copy len pixels of the line for all planes, the pixels are dst_step and src_step bytes apart.
+// Moving between upper and lower halves of the panel swaps the R,G,B bit groups.
+void DMD_RGB_BASE::move_pixels(uint8_t* dst, const uint8_t* src, uint16_t len, bool dst_lower, bool src_lower,
+	int16_t dst_step, int16_t src_step) {
+	uint8_t mask = dst_lower ? B111000 : B000111;
+
+	for (uint8_t b = 0; b < col_bytes_cnt; b++) {
+		uint8_t* d = dst;
+		const uint8_t* s_ptr = src;
+		for (uint16_t i = 0; i < len; i++) {
+			uint8_t s = *s_ptr;
+			if (src_lower != dst_lower) {
+				if (dst_lower) s <<= 3;
+				else s >>= 3;
+			}
+			*d = (*d & ~mask) | (s & mask);
+			d += dst_step;
+			s_ptr += src_step;
+		}
+		dst += displ_len;
+		src += displ_len;
+	}
+}
 /**************************************************************************/
 /*!
    @brief    Draw a perfectly vertical line (this is often optimized in a subclass!)
@@ -628,8 +1034,18 @@ void DMD_RGB_BASE::shiftScreen(int8_t step) {
 /**************************************************************************/
 void DMD_RGB_BASE::drawFastVLine(int16_t x, int16_t y,
 	int16_t h, uint16_t color) {
-	for (uint16_t yy = 0; yy < h; yy++) {
-		drawPixel(x, y + yy, color);
+
+	if (h <= 0) return;
+
+	if (fast_Hbyte) {
+		uint8_t fg_col_bytes[4];
+		getColorBytes(fg_col_bytes, color);
+		draw_line_run(x, y, 0xff, h, fg_col_bytes, fg_col_bytes, true);
+	}
+	else {
+		for (int16_t yy = 0; yy < h; yy++) {
+			drawPixel(x, y + yy, color);
+		}
 	}
 }
 
@@ -649,7 +1065,7 @@ void DMD_RGB_BASE::drawFastHLine(int16_t x, int16_t y,
 	if (w <= 0) return;
 
 	if (fast_Hbyte) {
-		uint8_t fg_col_bytes[col_bytes_cnt];
+		uint8_t fg_col_bytes[4];
 		getColorBytes(fg_col_bytes, color);
 		drawHByte(x, y, 255, w, fg_col_bytes, fg_col_bytes);
 
@@ -739,6 +1155,11 @@ DMD_RGB_BASE::~DMD_RGB_BASE()
 #if (defined(__STM32F1__) || defined(__STM32F4__))
 	free(matrixbuff[0]);
 
+#endif
+	free(bg_buff);
+	free(dither_table);
+#if (defined(__STM32F1__) || defined(__STM32F4__))
+	free(expand_swap);
 #endif
 #if defined(DEBUG2)
 	free((uint16_t*)dd_ptr);
@@ -33,6 +33,7 @@
 #if (defined(__STM32F1__)|| defined(__STM32F4__)) 
 
 void inline __attribute__((always_inline)) scan_running_dmd_R();
+void frame_running_dmd_R();
 
 #define COLOR_4BITS_Packed		3
 #endif
@@ -43,6 +44,8 @@ void inline __attribute__((always_inline)) scan_running_dmd_R();
 #define CLK_WITH_DATA   0x1
 #define CLK_AFTER_DATA   0
 
+class DMD_RGB_Layer;
+
 class DMD_RGB_BASE :
 	public DMD
 {
@@ -51,11 +54,38 @@ public:
 	DMD_RGB_BASE(byte mux_cnt, uint8_t* mux_list, byte _pin_nOE, byte _pin_SCLK, uint8_t* pinlist,
 		byte panelsWide, byte panelsHigh, bool d_buf, uint8_t col_depth, uint8_t n_Rows, byte dmd_pixel_x, byte dmd_pixel_y);
 
+	friend class DMD_RGB_Sprite;
+	friend class DMD_RGB_Animation;
+	friend class DMD_RGB_Transition;
+	friend class DMD_RGB_GIF;
+
 	// set desired FPS as init() parameter
 	void init(uint16_t scan_interval = 200) override;
 	virtual void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+	// draw count points of one color, xy holds x,y pairs of coordinates
+	void drawPixels(const int16_t* xy, uint16_t count, uint16_t color);
+	// draw w pixels of 8/8/8 RGB (3 bytes per pixel) from (x, y) to the right
+	void drawLine888(int16_t x, int16_t y, const uint8_t* rgb, uint16_t w);
+	// image of w * h pixels of 8/8/8 RGB, line by line
+	void drawBitmap888(int16_t x, int16_t y, const uint8_t* rgb, int16_t w, int16_t h);
+	void drawPixel888(int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b);
+
+ /**********************************************************************/
+ /*!
+   @brief   Ordered dithering of the 8/8/8 colors
+
+   Colors of drawLine888(), drawBitmap888() and drawPixel888() (and so of
+   the image and GIF players) are dithered down to the color depth of the
+   panel by the 4x4 Bayer matrix, instead of dropping the low bits.
+   Takes 256 bytes of RAM for the table of the color levels.
+
+   @return  false if no memory for the table
+ */
+ /**********************************************************************/
+	bool setDither(bool on);
 	void clearScreen(byte bNormal) override;
 	void shiftScreen(int8_t step) override;
+	void shiftScreenVertical(int8_t step) override;
 	void fillScreen(uint16_t color) override;
 
  /**********************************************************************/
@@ -78,8 +108,43 @@ public:
  /**********************************************************************/
 	void setMarqueeColor(DMD_Colorlist* colors);
 
+ /**********************************************************************/
+ /*!
+   @brief   Save the back buffer as static background for the overlay layers
+
+   Call after the background is completely drawn, the layers are merged
+   over it at swapBuffers(). See DMD_RGB_Layer.h
+ */
+ /**********************************************************************/
+	void saveBackground();
+	void addLayer(DMD_RGB_Layer* layer);
+	void swapBuffers(boolean copy) override;
+
+ /**********************************************************************/
+ /*!
+   @brief   Scroll the screen by the scan, without moving the buffer data
+
+   The scan starts from column x and line y of the buffer, so the image
+   moves left by x and up by y and wraps around. The offsets are in buffer
+   terms (without rotation).
+   Plain panels (scan of half of the height) on STM32 without RGB_DMA only,
+   vertical offset needs a single row of panels and the output through
+   the expand table (no DIRECT_OUTPUT).
+
+   @return  false if the scan can't do it
+ */
+ /**********************************************************************/
+	bool setScrollOffset(int16_t x, int16_t y);
+	int16_t getScrollOffsetX() { return scroll_x; }
+	int16_t getScrollOffsetY() { return scroll_y; }
+	// screen refreshes per second of the scan timings, the write time of the rows
+	// can make it lower than the rate requested by init()
+	uint16_t getFrameRate() { return frame_rate; }
+
 	
 	virtual void scan_dmd();
+	// end of the refresh of all rows, for the scans that switch the rows by DMA
+	void frameDone() { this->frame_count++; }
 	void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
 	void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
 	
@@ -113,6 +178,28 @@ protected:
 	virtual void drawHByte(int16_t x, int16_t y, uint8_t hbyte, uint16_t bsize, uint8_t* fg_col_bytes,
 		uint8_t* bg_col_bytes) override;
 	virtual void getColorBytes(uint8_t* cbytes, uint16_t color) override;
+	// scan_dmd_p1() and scan_dmd_p3() of the class handle the scroll offsets
+	virtual bool scan_offset_supported();
+	virtual void move_pixels(uint8_t* dst, const uint8_t* src, uint16_t len, bool dst_lower, bool src_lower,
+		int16_t dst_step = 1, int16_t src_step = 1);
+	// the part of the screen line from (x, y) to the right (or down if vertical), that lies
+	// in the buffer at the bytes with equal step inside one half of the panel.
+	// Returns its length up to len, the address of the first pixel in plane 0 and the step
+	uint16_t get_line_run(int16_t x, int16_t y, uint16_t len, uint16_t& addr, int16_t& step, bool& lower,
+		bool vertical = false);
+	// draw the run of hbyte bits or solid run (hbyte = 0xff) to the right or down if vertical
+	void draw_line_run(int16_t x, int16_t y, uint8_t hbyte, uint16_t bsize, uint8_t* fg_col_bytes,
+		uint8_t* bg_col_bytes, bool vertical);
+	// copy len pixels of the screen line (or column if vertical) between the buffers
+	void move_line(uint8_t* dst_buf, int16_t xd, int16_t yd, const uint8_t* src_buf, int16_t xs, int16_t ys,
+		uint16_t len, bool vertical = false);
+	// bits of the upper or lower half of the panel in every color byte
+	virtual const uint8_t* getColorByteMask(bool lower_half);
+	// 5/6/5 color of the 8/8/8 pixel at (x, y) of the screen, dithered if enabled
+	uint16_t color888_at(int16_t x, int16_t y, const uint8_t* rgb);
+	// merge changed rectangles of the layers to the back buffer
+	void compose_layers();
+	void restore_background(int16_t x0, int16_t y0, int16_t x1, int16_t y1);
 	
 	void  drawMarqueeString(int bX, int bY, const char* bChars, int length,
 		int16_t miny, int16_t maxy, byte orientation = 0) override;
@@ -125,6 +212,7 @@ protected:
 	// PORT register pointers 
 
 uint16_t           expand[256];           // 6-to-32 bit converter table
+uint16_t*          expand_swap = NULL;    // the same with upper and lower halves swapped
 
 #if defined(RGB_DMA)
 
@@ -150,6 +238,10 @@ uint16_t           expand[256];           // 6-to-32 bit converter table
 	// Counters/pointers for interrupt handler:
 	volatile uint8_t row, plane;
 	volatile uint8_t* buffptr;
+	// scroll offsets of the scan, the line of the lower half goes to the upper one if swapped
+	volatile uint16_t scroll_x = 0;
+	volatile uint8_t scroll_y = 0;
+	volatile bool row_swapped = false;
 	uint8_t nPlanes = 4;
 	const uint8_t pol_displ = DMD_PIXELS_DOWN / 2;
 	const uint8_t multiplex = pol_displ / nRows;
@@ -158,6 +250,15 @@ uint16_t           expand[256];           // 6-to-32 bit converter table
 	uint16_t colors[2] = { 0, 0 };
 	uint8_t col_cache[8] = { 0 };
 	uint8_t last_color = 0;
+	// for every 8-bit channel value: the lower level of the color depth (in 4-bit units)
+	// and the fraction to the next level in 1/16 (low nibble), NULL if no dithering
+	uint8_t* dither_table = NULL;
+	uint8_t dither_step = 1;
+
+	// overlay layers
+	uint8_t* bg_buff = NULL;
+	DMD_RGB_Layer* layers = NULL;
+	bool bg_refresh = false;        // second buffer of double buffer needs the new background
 
 	// interrupt cycles length (in clock tics)
 	uint32_t callOverhead;
@@ -165,6 +266,7 @@ uint16_t           expand[256];           // 6-to-32 bit converter table
 	uint16_t transfer_duty = 3;
 	uint16_t transfer_duty2 =1;
 	uint16_t default_fps = 200;
+	uint16_t frame_rate = 200;          // set by setCycleLen()
 #if (defined(ARDUINO_ARCH_RP2040))
 	uint16_t min_scan_len = 15;        // in uS
 #endif
@@ -294,6 +396,9 @@ public:
 
 	}
 
+/*--------------------------------------------------------------------------------------*/
+// plane 0 is built from the bits of all bytes, the scan doesn't use the scroll offsets
+bool scan_offset_supported() override { return false; }
 /*--------------------------------------------------------------------------------------*/
 virtual void scan_dmd_p3() override {
 
@@ -335,7 +440,7 @@ virtual void scan_dmd_p3() override {
 
 /*--------------------------------------------------------------------------------------*/
 void getColorBytes(uint8_t* cbytes, uint16_t color) override {
-	uint8_t r, g, b, bit, limit;
+	uint8_t r, g, b, bit;
 	uint8_t* ptr;
 
 	// special case color = 0
@@ -351,7 +456,6 @@ void getColorBytes(uint8_t* cbytes, uint16_t color) override {
 
 	ptr = col_cache + last_color * 3;
 	colors[last_color] = color;
-	ptr[0] = 0; ptr[1] = 0; ptr[2] = 0;
 
 	// Adafruit_GFX uses 16-bit color in 5/6/5 format, while matrix needs
 		// 4/4/4.  Pluck out relevant bits while separating into R,G,B:
@@ -361,158 +465,63 @@ void getColorBytes(uint8_t* cbytes, uint16_t color) override {
 	g = (c >> 7) & 0xF; // rrrrrGGGGggbbbbb
 	b = (c >> 1) & 0xF; // rrrrrggggggBBBBb
 
-	//if (nPlanes == 4) {
-
-	if (r & 1) { ptr[1] |= B10000000; ptr[2] |= B01000000; }
-	if (g & 1) { *ptr |= B01000000; ptr[2] |= B10000000; }// Plane 0 G: bit 0
-	if (b & 1) { *ptr |= B10000000; ptr[1] |= B01000000; }// Plane 0 B: bit 0
-
-
-	limit = 1 << nPlanes;
-	bit = 2;
-	for (; bit < limit; bit <<= 1) {
-		// Mask out R,G,B in one op
-		if (r & bit) *ptr |= B001001; // Plane N R: bit 2
-		if (g & bit) *ptr |= B010010; // Plane N G: bit 3
-		if (b & bit) *ptr |= B100100; // Plane N B: bit 4
+	// Plane 0 bits are spread about the two highest bits of all bytes
+	ptr[0] = ((g & 1) << 6) | ((b & 1) << 7);
+	ptr[1] = ((b & 1) << 6) | ((r & 1) << 7);
+	ptr[2] = ((r & 1) << 6) | ((g & 1) << 7);
 
-		ptr++;                 // Advance to next bit plane
+	// Planes 1-3, R,G,B bits of both halves
+	for (bit = 1; bit < nPlanes; bit++) {
+		ptr[bit - 1] |= (((r >> bit) & 1) * B001001) | (((g >> bit) & 1) * B010010) |
+			(((b >> bit) & 1) * B100100);
 		}
-	ptr -= 3;
 	memcpy(cbytes, ptr, 3); return;
 	}
 /*--------------------------------------------------------------------------------------*/
-void drawHByte(int16_t x, int16_t y, uint8_t hbyte, uint16_t bsize, uint8_t* fg_col_bytes,
-	uint8_t* bg_col_bytes) override {
+// Copy len pixels of the line between upper and lower halves of the panel.
+// Plane 0 bits are spread about the bytes, so moving across halves needs a remap
+void move_pixels(uint8_t* dst, const uint8_t* src, uint16_t len, bool dst_lower, bool src_lower,
+	int16_t dst_step = 1, int16_t src_step = 1) override {
 
 	static uint8_t ColorByteMask[] = { B00000111 , B01000111 , B11000111 ,
 										  B11111000 , B10111000 , B00111000 };
-
-	if ((hbyte != 0xff) && (bsize > 8)) bsize = 8;
-
-	//if whole line is outside - go out
-	if (((x + bsize) <= 0) || (x >= WIDTH) || (y < 0) || (y >= HEIGHT)) return;
-
-	//if start of line before 0 - draw portion of line from x=0
-	if (x < 0) {
-		bsize = bsize + x;
-		if (hbyte != 0xff) hbyte <<= (x * -1);
-		x = 0;
-		}
-
-	//if end of line after right edge of screen - draw until WIDTH-1
-	if ((x + bsize) > WIDTH) bsize = WIDTH - x;
-
-	// transform X & Y for Rotate and connect scheme
-
-	uint16_t base_addr = get_base_addr(x, y);
-	uint8_t* ptr_base = &matrixbuff[backindex][base_addr]; // Base addr
-
-	DEBUG_TIME_MARK;
-	uint8_t* mask_ptr, * mask;
-	uint8_t* col_bytes;
-	uint8_t* ptr = ptr_base;
-	if (y % DMD_PIXELS_DOWN < pol_displ) {
-		mask = ColorByteMask;
-		}
-	else {
-
-		mask = ColorByteMask + 3;
-		}
-	col_bytes = fg_col_bytes;
-	for (uint8_t j = 0; j < bsize; j++) {
-		if (hbyte != 0xff) {
-			if (hbyte & 0x80) {
-				col_bytes = fg_col_bytes;
-				}
+	uint8_t* mask = ColorByteMask;
+	if (dst_lower) mask += 3;
+
+	for (uint16_t i = 0; i < len; i++) {
+		uint8_t s0 = src[0];
+		uint8_t s1 = src[displ_len];
+		uint8_t s2 = src[displ_len * 2];
+		uint8_t n0 = s0, n1 = s1, n2 = s2;
+
+		if (src_lower != dst_lower) {
+			if (dst_lower) {
+				// upper -> lower
+				n0 = ((s0 & 0x07) << 3) | ((s2 & 0x80) >> 1) | ((s1 & 0x40) << 1);  // G0, B0
+				n1 = ((s1 & 0x07) << 3) | ((s2 & 0x40) << 1);                     // R0
+				n2 = (s2 & 0x07) << 3;
+			}
 			else {
-				col_bytes = bg_col_bytes;
-				}
-			hbyte <<= 1;
+				// lower -> upper
+				n0 = (s0 >> 3) & 0x07;
+				n1 = ((s1 >> 3) & 0x07) | ((s0 & 0x80) >> 1);                      // B0
+				n2 = ((s2 >> 3) & 0x07) | ((s1 & 0x80) >> 1) | ((s0 & 0x40) << 1); // R0, G0
 			}
-		mask_ptr = mask;
-		ptr = ptr_base + j;
-		*ptr &= ~(*mask_ptr);
-		*ptr |= (col_bytes[0] & *mask_ptr++);
-		ptr += displ_len;
-		*ptr &= ~(*mask_ptr);
-		*ptr |= (col_bytes[1] & *mask_ptr++);
-		ptr += displ_len;
-		*ptr &= ~(*mask_ptr);
-		*ptr |= (col_bytes[2] & *mask_ptr);
-
 		}
-	DEBUG_TIME_MARK;
-
+		dst[0] = (dst[0] & ~mask[0]) | (n0 & mask[0]);
+		dst[displ_len] = (dst[displ_len] & ~mask[1]) | (n1 & mask[1]);
+		dst[displ_len * 2] = (dst[displ_len * 2] & ~mask[2]) | (n2 & mask[2]);
+		dst += dst_step;
+		src += src_step;
 	}
+}
 /*--------------------------------------------------------------------------------------*/
-void drawPixel(int16_t x, int16_t y, uint16_t c) override {
-	uint8_t r, g, b, bit, limit, * ptr;
-
-
-	DEBUG_TIME_MARK_333;
-	DEBUG_TIME_MARK;
-	if (graph_mode == GRAPHICS_NOR) {
-		if (c == textcolor) c = textbgcolor;
-		else return;
-		}
-	if ((x < 0) || (x >= _width) || (y < 0) || (y >= _height)) return;
+const uint8_t* getColorByteMask(bool lower_half) override {
 
-	// transform X & Y for Rotate and connect scheme
-
-		// Adafruit_GFX uses 16-bit color in 5/6/5 format, while matrix needs
-		// 4/4/4.  Pluck out relevant bits while separating into R,G,B:
-	r = c >> 12;        // RRRRrggggggbbbbb
-	g = (c >> 7) & 0xF; // rrrrrGGGGggbbbbb
-	b = (c >> 1) & 0xF; // rrrrrggggggBBBBb
-
-	uint16_t base_addr = get_base_addr(x, y);
-	ptr = &matrixbuff[backindex][base_addr]; // Base addr
-	DEBUG_TIME_MARK;
-	bit = 2;
-	limit = 1 << nPlanes;
-	if (y % DMD_PIXELS_DOWN < pol_displ) {
-		// Data for the upper half of the display is stored in the lower
-		// bits of each byte.
-
-		// Plane 0 is a tricky case -- its data is spread about,
-		// stored in least two bits not used by the other planes.
-		ptr[displ_len * 2] &= ~B11000000;           // Plane 0 R,G mask out in one op
-		if (r & 1) ptr[displ_len * 2] |= B01000000; // Plane 0 R: 64 bytes ahead, bit 0
-		if (g & 1) ptr[displ_len * 2] |= B10000000; // Plane 0 G: 64 bytes ahead, bit 1
-		if (b & 1) ptr[displ_len] |= B01000000; // Plane 0 B: 32 bytes ahead, bit 0
-		else      ptr[displ_len] &= ~B01000000; // Plane 0 B unset; mask out
-		// The remaining three image planes are more normal-ish.
-		// Data is stored in the high 6 bits so it can be quickly
-		// copied to the DATAPORT register w/6 output lines.
-		for (; bit < limit; bit <<= 1) {
-			*ptr &= ~B000111;            // Mask out R,G,B in one op
-			if (r & bit) *ptr |= B000001; // Plane N R: bit 2
-			if (g & bit) *ptr |= B000010; // Plane N G: bit 3
-			if (b & bit) *ptr |= B000100; // Plane N B: bit 4
-			ptr += displ_len;                 // Advance to next bit plane
-			}
-		}
-	else {
-		// Data for the lower half of the display is stored in the upper
-		// bits, except for the plane 0 stuff, using 2 least bits.
-
-		*ptr &= ~B11000000;                  // Plane 0 G,B mask out in one op
-		if (r & 1)  ptr[displ_len] |= B10000000; // Plane 0 R: 32 bytes ahead, bit 1
-		else       ptr[displ_len] &= ~B10000000; // Plane 0 R unset; mask out
-		if (g & 1) *ptr |= B01000000; // Plane 0 G: bit 0
-		if (b & 1) *ptr |= B10000000; // Plane 0 B: bit 0
-		for (; bit < limit; bit <<= 1) {
-			*ptr &= ~B111000;            // Mask out R,G,B in one op
-			if (r & bit) *ptr |= B001000; // Plane N R: bit 5
-			if (g & bit) *ptr |= B010000; // Plane N G: bit 6
-			if (b & bit) *ptr |= B100000; // Plane N B: bit 7
-			ptr += displ_len;                 // Advance to next bit plane
-			}
-		}
-	DEBUG_TIME_MARK;
-
-	}
+	static const uint8_t ColorByteMask[] = { B00000111 , B01000111 , B11000111 ,
+										  B11111000 , B10111000 , B00111000 };
+	return lower_half ? ColorByteMask + 3 : ColorByteMask;
+}
 };
 #endif  // if (defined(__STM32F1__)|| defined(__STM32F4__))
 
@@ -0,0 +1,87 @@
+/*--------------------------------------------------------------------------------------
+ This file is a part of the library DMD_STM32
+
+ DMD_STM32.h  - STM32 port of DMD.h library
+
+ https://github.com/board707/DMD_STM32
+ Dmitry Dmitriev (c) 2019-2023
+ /--------------------------------------------------------------------------------------*/
+#include "DMD_RGB_Animation.h"
+
+DMD_RGB_Animation::DMD_RGB_Animation(DMD_RGB_BASE* disp, const uint8_t* anim_data)
+	: dmd(disp), data(anim_data)
+{
+	valid = (data[0] == 'D') && (data[1] == 'M') && (data[2] == 'A') && (data[3] == DMD_ANIM_VERSION) &&
+		(read16(data + 4) == dmd->WIDTH) && (read16(data + 6) == dmd->HEIGHT) &&
+		(read32(data + 8) == dmd->mem_Buffer_Size) && (data[12] == dmd->col_bytes_cnt);
+	if (valid) frames = read16(data + 14);
+	if (frames == 0) valid = false;
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_Animation::start(bool loop) {
+	if (!valid) return;
+	looping = loop;
+	cur_frame = 0;
+	next_rec = show_record(data + DMD_ANIM_HEADER_SIZE);
+	running = true;
+}
+/*--------------------------------------------------------------------------------------*/
+bool DMD_RGB_Animation::update() {
+	if (!running) return false;
+	if ((dmd->getFrameCount() - frame_start) < duration) return false;
+
+	if (++cur_frame >= frames) {
+		if (!looping) {
+			running = false;
+			return false;
+		}
+		cur_frame = 0;
+		const uint8_t* first = data + DMD_ANIM_HEADER_SIZE;
+		if (data[13] & DMD_ANIM_LOOP_DELTA) {
+			// loop record goes after the last frame and turns it to the first one
+			show_record(next_rec);
+			next_rec = first + DMD_ANIM_RECORD_SIZE + read32(first + 4);
+		}
+		else next_rec = show_record(first);
+		return true;
+	}
+	next_rec = show_record(next_rec);
+	return true;
+}
+/*--------------------------------------------------------------------------------------*/
+const uint8_t* DMD_RGB_Animation::show_record(const uint8_t* rec) {
+
+	bool delta = (rec[0] == DMD_ANIM_DELTA_FRAME);
+	duration = read16(rec + 2);
+	uint32_t len = read32(rec + 4);
+	const uint8_t* src = rec + DMD_ANIM_RECORD_SIZE;
+	const uint8_t* end = src + len;
+	uint8_t* dst = dmd->matrixbuff[dmd->backindex];
+	uint8_t* dst_end = dst + dmd->mem_Buffer_Size;
+	// key frames don't keep the output bit of DIRECT_OUTPUT mode
+	uint8_t out = dmd->output_mask;
+
+	while ((src < end) && (dst < dst_end)) {
+		uint8_t code = *src++;
+		uint16_t n;
+		if (code < 0x80) {
+			n = code + 1;
+			if (delta) while (n--) *dst++ ^= *src++;
+			else while (n--) *dst++ = *src++ | out;
+		}
+		else if (code < 0xC0) {
+			n = (code & 0x3F) + 1;
+			uint8_t val = *src++;
+			if (delta) while (n--) *dst++ ^= val;
+			else while (n--) *dst++ = val | out;
+		}
+		else {
+			n = (((code & 0x3F) << 8) | *src++) + 1;
+			if (delta) dst += n;
+			else while (n--) *dst++ = out;
+		}
+	}
+	dmd->swapBuffers(true);
+	frame_start = dmd->getFrameCount();
+	return end;
+}
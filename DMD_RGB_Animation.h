@@ -0,0 +1,84 @@
+#pragma once
+#ifndef DMD_RGB_ANIMATION_H
+#define DMD_RGB_ANIMATION_H
+/*--------------------------------------------------------------------------------------
+ This file is a part of the DMD_STM32 library
+
+ DMD_STM32.h  - STM32 port of DMD.h library
+
+ https://github.com/board707/DMD_STM32
+ Dmitry Dmitriev (c) 2019-2023
+/--------------------------------------------------------------------------------------*/
+
+// Animation player for RGB panels
+
+// Frames are stored in flash in the format of the matrix buffer:
+// key frames are complete buffers, delta frames are XOR with the previous frame,
+// both RLE-compressed. The data is prepared on PC from a folder of PPM images
+// by extras/dmd_anim_encoder.py for the given panel template, color depth and
+// number of panels. Only plain panel templates (RGBxxplainSxx) are supported,
+// without rotation and with default connect scheme.
+//
+// Every frame is decoded to the back buffer and shown by swapBuffers(true),
+// the frame duration is counted in the screen refresh cycles.
+/*--------------------------------------------------------------------------------------*/
+#include "DMD_RGB.h"
+
+// Data layout, all numbers are little-endian:
+//  header:
+//   0  'D','M','A', version
+//   4  uint16 width, uint16 height - screen size
+//   8  uint32 size of matrix buffer
+//  12  uint8 color bytes per pixel, uint8 flags, uint16 number of frames
+//  frame record:
+//   0  uint8 type, uint8 reserved, uint16 duration, uint32 length of data, data
+//  If DMD_ANIM_LOOP_DELTA is set, the record after the last frame changes it
+//  back to the first one.
+//
+// RLE data codes:
+//   0x00-0x7F n     : n+1 bytes follow
+//   0x80-0xBF n     : next byte repeated n+1 times
+//   0xC0-0xFF n, m  : ((n & 0x3F) << 8 | m) + 1 zero bytes, skipped in delta frames
+#define DMD_ANIM_VERSION        1
+#define DMD_ANIM_HEADER_SIZE   16
+#define DMD_ANIM_RECORD_SIZE    8
+#define DMD_ANIM_KEY_FRAME      0
+#define DMD_ANIM_DELTA_FRAME    1
+#define DMD_ANIM_LOOP_DELTA     0x01
+
+class DMD_RGB_Animation
+{
+public:
+	DMD_RGB_Animation(DMD_RGB_BASE* disp, const uint8_t* anim_data);
+
+	// the data was made for this matrix
+	bool isValid() { return valid; }
+	// show the first frame
+	void start(bool loop = true);
+	void stop() { running = false; }
+	bool isRunning() { return running; }
+	// call it from loop() - shows the next frame when the time of the current one is out,
+	// returns true if the frame is changed
+	bool update();
+
+	uint16_t getFrames() { return frames; }
+	uint16_t getCurrentFrame() { return cur_frame; }
+
+protected:
+	static uint16_t read16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+	static uint32_t read32(const uint8_t* p) { return read16(p) | ((uint32_t)read16(p + 2) << 16); }
+	// decode the record to the back buffer and swap, returns the next record
+	const uint8_t* show_record(const uint8_t* rec);
+
+	DMD_RGB_BASE* dmd;
+	const uint8_t* data;
+	const uint8_t* next_rec = NULL;
+	uint16_t frames = 0;
+	uint16_t cur_frame = 0;
+	uint16_t duration = 0;
+	uint32_t frame_start = 0;
+	bool valid = false;
+	bool looping = true;
+	bool running = false;
+};
+#endif
@@ -103,6 +103,8 @@ class DMD_RGB_FM6126_BASE : public DMD_RGB<MUX_CNT, P_Width, P_Height, SCAN, SCA
 
 			}
 #endif
+		// scan of the chip doesn't use the scroll offsets
+		bool scan_offset_supported() override { return false; }
 
 
 	};
@@ -80,6 +80,12 @@ class DMD_RGB_FM6353_BASE : public DMD_RGB<MUX_CNT, P_Width, P_Height, SCAN, SCA
 
 		void generate_rgbtable()  override { DMD_RGB_BASE::generate_rgbtable_default(CLK_WITH_DATA); }
 
+		// the rows are switched at every period of MAIN_TIMER, see initialize_timers()
+		void setCycleLen() override {
+			DMD_RGB_BASE::setCycleLen();
+			this->frame_rate = (CYCLES_PER_MICROSECOND * 1000000ul) / ((uint32_t)this->nRows * (GCLK_NUM * TIM3_PERIOD + 8 * ADD_NUM));
+			}
+
 
 		virtual void init(uint16_t scan_interval = 200) override {
 			this->oe_scan_flag = false;
@@ -106,6 +112,7 @@ class DMD_RGB_FM6353_BASE : public DMD_RGB<MUX_CNT, P_Width, P_Height, SCAN, SCA
 		// GCLK pulse packets generated by PWM1 mode of OE_TIMER on its output pin.
 		// To insure exact number of GCLK pulses in packet, OE_TIMER start/stop is triggered by CH1 of MAIN_TIMER (Master mode)
 		// Line switching is going by DMA on CH3 (STM32F1) or by CH2 compare match interrupt (STM32F4) 
+		// Frames are counted by transfer complete interrupt of the DMA (STM32F1) or in scan_dmd() (STM32F4)
 		void initialize_timers(voidFuncPtr handler) override {
 
 			timer_init(this->MAIN_TIMER);
@@ -130,8 +137,10 @@ class DMD_RGB_FM6353_BASE : public DMD_RGB<MUX_CNT, P_Width, P_Height, SCAN, SCA
 #if defined(__STM32F1__) 
 			// setup DMA transfer from mux table to A B C D E GPIOs
 			dma_init(rgbDmaDev);
-			dma_setup_transfer(rgbDmaDev, DmaMuxChannel, (uint32_t*)this->muxsetreg, DMA_SIZE_32BITS, (uint32_t*)this->mux_mask2 + 1, DMA_SIZE_32BITS, (DMA_MINC_MODE | DMA_CIRC_MODE | DMA_FROM_MEM));
+			dma_setup_transfer(rgbDmaDev, DmaMuxChannel, (uint32_t*)this->muxsetreg, DMA_SIZE_32BITS, (uint32_t*)this->mux_mask2 + 1, DMA_SIZE_32BITS, (DMA_MINC_MODE | DMA_CIRC_MODE | DMA_FROM_MEM | DMA_TRNS_CMPLT));
 			dma_set_num_transfers(rgbDmaDev, DmaMuxChannel, this->nRows);
+			// the table is passed once per frame
+			dma_attach_interrupt(rgbDmaDev, DmaMuxChannel, frame_running_dmd_R);
 			dma_enable(rgbDmaDev, DmaMuxChannel);
 
 #elif defined(__STM32F4__) 
@@ -180,6 +189,9 @@ class DMD_RGB_FM6353_BASE : public DMD_RGB<MUX_CNT, P_Width, P_Height, SCAN, SCA
 
 			}
 
+		// scan of the chip doesn't use the scroll offsets
+		bool scan_offset_supported() override { return false; }
+
 		// interrupt handler
 		void scan_dmd() override {
 
@@ -194,7 +206,10 @@ class DMD_RGB_FM6353_BASE : public DMD_RGB<MUX_CNT, P_Width, P_Height, SCAN, SCA
 			else {
 				this->set_mux(this->row);
 				this->row++;
-				if (this->row >= this->nRows) this->row = 0;
+				if (this->row >= this->nRows) {
+					this->row = 0;
+					this->frame_count++;
+					}
 				}
 #endif
 			this->oe_scan_res = false;
@@ -239,7 +254,7 @@ class DMD_RGB_FM6353_BASE : public DMD_RGB<MUX_CNT, P_Width, P_Height, SCAN, SCA
 			timer_pause(this->OE_TIMER);
 			timer_set_compare(this->MAIN_TIMER, 1, this->GCLK_NUM * this->TIM3_PERIOD);
 #if defined(__STM32F1__) 
-			dma_setup_transfer(rgbDmaDev, DmaMuxChannel, (uint32_t*)this->muxsetreg, DMA_SIZE_32BITS, (uint32_t*)this->mux_mask2 + 1, DMA_SIZE_32BITS, (DMA_MINC_MODE | DMA_CIRC_MODE | DMA_FROM_MEM));
+			dma_setup_transfer(rgbDmaDev, DmaMuxChannel, (uint32_t*)this->muxsetreg, DMA_SIZE_32BITS, (uint32_t*)this->mux_mask2 + 1, DMA_SIZE_32BITS, (DMA_MINC_MODE | DMA_CIRC_MODE | DMA_FROM_MEM | DMA_TRNS_CMPLT));
 			dma_set_num_transfers(rgbDmaDev, DmaMuxChannel, this->nRows);
 			dma_enable(rgbDmaDev, DmaMuxChannel);
 #endif		
@@ -0,0 +1,312 @@
+/*--------------------------------------------------------------------------------------
+ This file is a part of the library DMD_STM32
+
+ DMD_STM32.h  - STM32 port of DMD.h library
+
+ https://github.com/board707/DMD_STM32
+ Dmitry Dmitriev (c) 2019-2023
+ /--------------------------------------------------------------------------------------*/
+#include "DMD_RGB_GIF.h"
+
+#define GIF_EXTENSION    0x21
+#define GIF_IMAGE        0x2C
+#define GIF_TRAILER      0x3B
+#define GIF_GRAPHIC_CTRL 0xF9
+
+// rows of the interlaced image go in 4 passes
+static const uint8_t interlace_start[4] = { 0, 4, 2, 1 };
+static const uint8_t interlace_step[4] = { 8, 8, 4, 2 };
+/*--------------------------------------------------------------------------------------*/
+DMD_RGB_GIF::DMD_RGB_GIF(DMD_RGB_BASE* disp, const uint8_t* gif_data, uint32_t gif_size)
+	: dmd(disp), data(gif_data), data_end(gif_data + gif_size)
+{
+	// header and logical screen descriptor
+	if ((gif_size < 13) || memcmp(data, "GIF8", 4) || ((data[4] != '7') && (data[4] != '9')) || (data[5] != 'a')) return;
+	width = read16(data + 6);
+	height = read16(data + 8);
+	first_block = data + 13;
+	if (data[10] & 0x80) {
+		global_palette = first_block;
+		global_colors = 2 << (data[10] & 0x07);
+		first_block += global_colors * 3;
+	}
+	valid = (width > 0) && (height > 0) && (first_block < data_end);
+}
+/*--------------------------------------------------------------------------------------*/
+bool DMD_RGB_GIF::start(bool loop) {
+	if (!valid) return false;
+	release();
+	prefix = (uint16_t*)malloc(GIF_MAX_CODES * sizeof(uint16_t));
+	suffix = (uint8_t*)malloc(GIF_MAX_CODES);
+	stack = (uint8_t*)malloc(GIF_MAX_CODES);
+	line = (uint8_t*)malloc(width * 4ul);
+	if ((prefix == NULL) || (suffix == NULL) || (stack == NULL) || (line == NULL)) {
+		release();
+		return false;
+	}
+	looping = loop;
+	cur_frame = 0;
+	disposal = GIF_DISPOSE_NONE;
+	ptr = first_block;
+	running = show_frame();
+	if (!running) release();
+	return running;
+}
+/*--------------------------------------------------------------------------------------*/
+bool DMD_RGB_GIF::update() {
+	if (!running) return false;
+	if ((dmd->getFrameCount() - frame_start) < duration) return false;
+
+	if ((ptr >= data_end) || (*ptr == GIF_TRAILER)) {
+		if (!looping) {
+			stop();
+			return false;
+		}
+		// the canvas starts from scratch
+		dmd->fillRect(pos_x, pos_y, width, height, 0);
+		disposal = GIF_DISPOSE_NONE;
+		ptr = first_block;
+		cur_frame = 0;
+	}
+	else {
+		dispose();
+		cur_frame++;
+	}
+	if (!show_frame()) {
+		stop();
+		return false;
+	}
+	return true;
+}
+/*--------------------------------------------------------------------------------------*/
+// Blocks before the image: only Graphic Control Extension is used,
+// other extensions (comments, loop count etc.) are skipped
+bool DMD_RGB_GIF::show_frame() {
+
+	uint8_t frame_disposal = GIF_DISPOSE_NONE;
+	uint16_t delay = 0;
+	trans_index = -1;
+
+	while (ptr < data_end) {
+		uint8_t tag = *ptr++;
+		if (tag == GIF_EXTENSION) {
+			if (ptr >= data_end) return false;
+			uint8_t label = *ptr++;
+			if ((label == GIF_GRAPHIC_CTRL) && (ptr + 5 < data_end) && (ptr[0] == 4)) {
+				frame_disposal = (ptr[1] >> 2) & 0x07;
+				delay = read16(ptr + 2);
+				if (ptr[1] & 0x01) trans_index = ptr[4];
+			}
+			if (!skip_blocks()) return false;
+		}
+		else if (tag == GIF_IMAGE) {
+			if (ptr + 9 > data_end) return false;
+			frame_x = read16(ptr);
+			frame_y = read16(ptr + 2);
+			frame_w = read16(ptr + 4);
+			frame_h = read16(ptr + 6);
+			uint8_t flags = ptr[8];
+			ptr += 9;
+			palette = global_palette;
+			palette_colors = global_colors;
+			if (flags & 0x80) {
+				palette = ptr;
+				palette_colors = 2 << (flags & 0x07);
+				ptr += palette_colors * 3;
+			}
+			interlaced = flags & 0x40;
+			if ((palette == NULL) || (ptr >= data_end) ||
+				((uint32_t)frame_x + frame_w > width) || ((uint32_t)frame_y + frame_h > height)) return false;
+
+			disposal = frame_disposal;
+			if (disposal == GIF_DISPOSE_PREVIOUS) {
+				if (saved_buf == NULL) saved_buf = (uint8_t*)malloc(dmd->mem_Buffer_Size);
+				if (saved_buf) memcpy(saved_buf, dmd->matrixbuff[dmd->backindex], dmd->mem_Buffer_Size);
+			}
+			if (!decode_image()) return false;
+
+			// short delays are shown as 100 ms, as the browsers do
+			if (delay < 2) delay = 10;
+			// in screen refreshes at the real rate of the scan, not the requested one
+			duration = (uint32_t)delay * dmd->getFrameRate() / 100;
+			dmd->swapBuffers(true);
+			frame_start = dmd->getFrameCount();
+			return true;
+		}
+		else return false;
+	}
+	return false;
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_GIF::dispose() {
+
+	if (disposal == GIF_DISPOSE_BACKGROUND) {
+		dmd->fillRect(pos_x + frame_x, pos_y + frame_y, frame_w, frame_h, 0);
+	}
+	else if ((disposal == GIF_DISPOSE_PREVIOUS) && saved_buf) {
+		memcpy(dmd->matrixbuff[dmd->backindex], saved_buf, dmd->mem_Buffer_Size);
+	}
+}
+/*--------------------------------------------------------------------------------------*/
+// LZW decoder with the tables of prefix codes and last pixels of the strings,
+// the string of the code is taken from the end, so it goes through the stack
+bool DMD_RGB_GIF::decode_image() {
+
+	uint8_t min_size = *ptr++;
+	if ((min_size < 2) || (min_size > 8)) return false;
+
+	line_x = 0;
+	line_y = 0;
+	pass = 0;
+	block_left = 0;
+	bit_cnt = 0;
+	bit_buf = 0;
+	blocks_done = false;
+
+	uint16_t clear = 1 << min_size;
+	uint16_t next = clear + 2;
+	uint8_t code_size = min_size + 1;
+	int16_t old = -1;
+	uint8_t first = 0;
+	uint32_t left = (uint32_t)frame_w * frame_h;
+
+	while (left > 0) {
+		int16_t code = get_code(code_size);
+		if ((code < 0) || (code == clear + 1)) break;
+		if (code == clear) {
+			next = clear + 2;
+			code_size = min_size + 1;
+			old = -1;
+			continue;
+		}
+		if (old < 0) {
+			if (code > clear) break;
+			first = code;
+			old = code;
+			put_pixel(code);
+			left--;
+			continue;
+		}
+		int16_t in_code = code;
+		uint16_t sp = 0;
+		if (code >= next) {
+			if (code > next) break;
+			// the string of the old code and its first pixel
+			stack[sp++] = first;
+			code = old;
+		}
+		while (code >= clear) {
+			stack[sp++] = suffix[code];
+			code = prefix[code];
+		}
+		first = code;
+		stack[sp++] = first;
+		if (next < GIF_MAX_CODES) {
+			prefix[next] = old;
+			suffix[next] = first;
+			next++;
+			if ((next == (1u << code_size)) && (code_size < 12)) code_size++;
+		}
+		old = in_code;
+		while ((sp > 0) && (left > 0)) {
+			put_pixel(stack[--sp]);
+			left--;
+		}
+	}
+	// the rest of the data, if any
+	if (blocks_done) return true;
+	ptr += block_left;
+	return skip_blocks();
+}
+/*--------------------------------------------------------------------------------------*/
+int16_t DMD_RGB_GIF::get_code(uint8_t code_size) {
+
+	while (bit_cnt < code_size) {
+		if (block_left == 0) {
+			if ((ptr >= data_end) || (*ptr == 0)) {
+				if (ptr < data_end) ptr++;
+				blocks_done = true;
+				return -1;
+			}
+			block_left = *ptr++;
+		}
+		if (ptr >= data_end) {
+			blocks_done = true;
+			return -1;
+		}
+		bit_buf |= (uint32_t)(*ptr++) << bit_cnt;
+		bit_cnt += 8;
+		block_left--;
+	}
+	int16_t code = bit_buf & ((1 << code_size) - 1);
+	bit_buf >>= code_size;
+	bit_cnt -= code_size;
+	return code;
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_GIF::put_pixel(uint8_t index) {
+
+	line[line_x++] = index;
+	if (line_x < frame_w) return;
+
+	flush_line();
+	line_x = 0;
+	if (interlaced) {
+		line_y += interlace_step[pass];
+		while ((line_y >= frame_h) && (pass < 3)) {
+			pass++;
+			line_y = interlace_start[pass];
+		}
+	}
+	else line_y++;
+}
+/*--------------------------------------------------------------------------------------*/
+// Runs of opaque pixels are converted to 8/8/8 colors after the indexes
+// and drawn by drawLine888()
+void DMD_RGB_GIF::flush_line() {
+
+	uint8_t* rgb = line + frame_w;
+	uint16_t x = 0;
+	while (x < frame_w) {
+		if (line[x] == trans_index) {
+			x++;
+			continue;
+		}
+		uint16_t x1 = x;
+		uint8_t* p = rgb;
+		while ((x1 < frame_w) && (line[x1] != trans_index)) {
+			// indexes out of the palette take the first color
+			const uint8_t* c = palette + ((line[x1] < palette_colors) ? line[x1] * 3 : 0);
+			*p++ = c[0];
+			*p++ = c[1];
+			*p++ = c[2];
+			x1++;
+		}
+		dmd->drawLine888(pos_x + frame_x + x, pos_y + frame_y + line_y, rgb, x1 - x);
+		x = x1;
+	}
+}
+/*--------------------------------------------------------------------------------------*/
+bool DMD_RGB_GIF::skip_blocks() {
+
+	while (ptr < data_end) {
+		uint8_t len = *ptr++;
+		if (len == 0) return true;
+		ptr += len;
+	}
+	return false;
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_GIF::release() {
+
+	free(prefix);
+	free(suffix);
+	free(stack);
+	free(line);
+	free(saved_buf);
+	prefix = NULL;
+	suffix = NULL;
+	stack = NULL;
+	line = NULL;
+	saved_buf = NULL;
+}
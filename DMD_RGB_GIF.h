@@ -0,0 +1,117 @@
+#pragma once
+#ifndef DMD_RGB_GIF_H
+#define DMD_RGB_GIF_H
+/*--------------------------------------------------------------------------------------
+ This file is a part of the DMD_STM32 library
+
+ DMD_STM32.h  - STM32 port of DMD.h library
+
+ https://github.com/board707/DMD_STM32
+ Dmitry Dmitriev (c) 2019-2023
+/--------------------------------------------------------------------------------------*/
+
+// Animated GIF player for RGB panels
+
+// The GIF file is kept in flash (or RAM) as is, frames are decoded from it
+// when they are shown. LZW codes are expanded through the palette straight
+// to the back buffer line by line, only the rectangle of the frame is drawn.
+// Transparent pixels keep the previous content of the buffer, frame disposal:
+//  none / leave in place   - the frame stays under the next one
+//  restore to background   - the rectangle of the frame is cleared to black
+//  restore to previous     - the buffer is restored from the copy made before the frame
+//
+// Every frame is drawn to the back buffer and shown by swapBuffers(true),
+// the frame delays are converted to the screen refresh cycles by getFrameRate()
+// of the display.
+// RAM: 16 KBytes of LZW tables and a line buffer of 4 bytes per pixel of the
+// GIF width while playing, and one more matrix buffer if a frame is restored
+// to previous.
+/*--------------------------------------------------------------------------------------*/
+#include "DMD_RGB.h"
+
+#define GIF_DISPOSE_NONE        0
+#define GIF_DISPOSE_LEAVE       1
+#define GIF_DISPOSE_BACKGROUND  2
+#define GIF_DISPOSE_PREVIOUS    3
+
+#define GIF_MAX_CODES        4096
+
+class DMD_RGB_GIF
+{
+public:
+	DMD_RGB_GIF(DMD_RGB_BASE* disp, const uint8_t* gif_data, uint32_t gif_size);
+	~DMD_RGB_GIF() { release(); }
+
+	// the data is GIF
+	bool isValid() { return valid; }
+	// place of top left corner of the GIF screen
+	void setPosition(int16_t x, int16_t y) { pos_x = x; pos_y = y; }
+	// show the first frame, returns false if no memory for the decoder
+	bool start(bool loop = true);
+	void stop() { running = false; release(); }
+	bool isRunning() { return running; }
+	// call it from loop() - shows the next frame when the time of the current one is out,
+	// returns true if the frame is changed
+	bool update();
+
+	uint16_t getWidth() { return width; }
+	uint16_t getHeight() { return height; }
+	uint16_t getCurrentFrame() { return cur_frame; }
+
+protected:
+	static uint16_t read16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+	// decode the next frame to the back buffer and swap, false at the end of the data
+	bool show_frame();
+	// dispose the last shown frame
+	void dispose();
+	bool decode_image();
+	// next LZW code of code_size bits from the data sub-blocks, -1 at the end of data
+	int16_t get_code(uint8_t code_size);
+	void put_pixel(uint8_t index);
+	void flush_line();
+	// go over the data sub-blocks
+	bool skip_blocks();
+	void release();
+
+	DMD_RGB_BASE* dmd;
+	const uint8_t* data;
+	const uint8_t* data_end;
+	const uint8_t* first_block = NULL;
+	const uint8_t* ptr = NULL;        // next block of the GIF
+	const uint8_t* global_palette = NULL;
+	uint16_t global_colors = 0;
+
+	// decoder tables, allocated by start()
+	uint16_t* prefix = NULL;
+	uint8_t* suffix = NULL;
+	uint8_t* stack = NULL;
+	uint8_t* line = NULL;             // palette indexes of the line, then 8/8/8 colors
+	uint8_t* saved_buf = NULL;        // buffer for GIF_DISPOSE_PREVIOUS
+
+	// LZW bit reader
+	uint8_t block_left = 0;
+	uint8_t bit_cnt = 0;
+	uint32_t bit_buf = 0;
+	bool blocks_done = false;         // terminator of the sub-blocks is read
+
+	// current frame
+	const uint8_t* palette = NULL;
+	uint16_t palette_colors = 0;
+	int16_t trans_index = -1;
+	uint16_t frame_x = 0, frame_y = 0, frame_w = 0, frame_h = 0;
+	uint16_t line_x = 0, line_y = 0;
+	uint8_t pass = 0;
+	bool interlaced = false;
+	uint8_t disposal = GIF_DISPOSE_NONE;
+
+	int16_t pos_x = 0, pos_y = 0;
+	uint16_t width = 0;
+	uint16_t height = 0;
+	uint16_t cur_frame = 0;
+	uint32_t duration = 0;
+	uint32_t frame_start = 0;
+	bool valid = false;
+	bool looping = true;
+	bool running = false;
+};
+#endif
@@ -0,0 +1,221 @@
+/*--------------------------------------------------------------------------------------
+ This file is a part of the library DMD_STM32
+
+ DMD_STM32.h  - STM32 port of DMD.h library
+
+ https://github.com/board707/DMD_STM32
+ Dmitry Dmitriev (c) 2019-2023
+ /--------------------------------------------------------------------------------------*/
+#include "DMD_RGB_Image.h"
+
+#define QOI_OP_INDEX  0x00
+#define QOI_OP_DIFF   0x40
+#define QOI_OP_LUMA   0x80
+#define QOI_OP_RUN    0xC0
+#define QOI_OP_RGB    0xFE
+#define QOI_OP_RGBA   0xFF
+#define QOI_END_SIZE  8
+/*--------------------------------------------------------------------------------------*/
+bool DMD_RGB_Image::draw(Stream& s, int16_t x, int16_t y) {
+
+	format = IMAGE_NONE;
+	img_width = 0;
+	img_height = 0;
+	uint8_t sign[2];
+	if (!read(s, sign, 2)) return false;
+
+	bool res = false;
+	if ((sign[0] == 'q') && (sign[1] == 'o')) {
+		format = IMAGE_QOI;
+		res = decode_qoi(s, x, y);
+	}
+	else if ((sign[0] == 'B') && (sign[1] == 'M')) {
+		format = IMAGE_BMP;
+		res = decode_bmp(s, x, y);
+	}
+	else if ((sign[0] == 'P') && (sign[1] == '6')) {
+		format = IMAGE_PPM;
+		res = decode_ppm(s, x, y);
+	}
+	release();
+	return res;
+}
+/*--------------------------------------------------------------------------------------*/
+// Pixels are decoded to the line buffer, the index of seen colors
+// is the only other state of the decoder
+bool DMD_RGB_Image::decode_qoi(Stream& s, int16_t x, int16_t y) {
+
+	// rest of "qoif", big-endian width and height, channels, colorspace
+	uint8_t hdr[12];
+	if (!read(s, hdr, 12) || (hdr[0] != 'i') || (hdr[1] != 'f')) return false;
+	uint32_t w = read32_be(hdr + 2);
+	uint32_t h = read32_be(hdr + 6);
+	if ((w == 0) || (w > 0xFFFF / 3) || (h > 0xFFFF)) return false;
+	img_width = w;
+	img_height = h;
+	if (alloc_line(w * 3) == NULL) return false;
+
+	uint8_t index[64][4];
+	memset(index, 0, sizeof(index));
+	uint8_t px[4] = { 0, 0, 0, 255 };
+	uint8_t run = 0;
+
+	for (uint16_t row = 0; row < h; row++) {
+		uint8_t* ptr = line;
+		for (uint16_t i = 0; i < w; i++) {
+			if (run > 0) run--;
+			else {
+				uint8_t op[2];
+				if (!read(s, op, 1)) return false;
+				if (op[0] == QOI_OP_RGB) {
+					if (!read(s, px, 3)) return false;
+				}
+				else if (op[0] == QOI_OP_RGBA) {
+					if (!read(s, px, 4)) return false;
+				}
+				else switch (op[0] & 0xC0) {
+				case QOI_OP_INDEX:
+					memcpy(px, index[op[0]], 4);
+					break;
+				case QOI_OP_DIFF:
+					px[0] += ((op[0] >> 4) & 0x03) - 2;
+					px[1] += ((op[0] >> 2) & 0x03) - 2;
+					px[2] += (op[0] & 0x03) - 2;
+					break;
+				case QOI_OP_LUMA: {
+					if (!read(s, op + 1, 1)) return false;
+					int8_t dg = (op[0] & 0x3F) - 32;
+					px[0] += dg - 8 + (op[1] >> 4);
+					px[1] += dg;
+					px[2] += dg - 8 + (op[1] & 0x0F);
+					break;
+				}
+				default:
+					// this pixel and the next ones
+					run = op[0] & 0x3F;
+					break;
+				}
+				memcpy(index[(px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64], px, 4);
+			}
+			*ptr++ = px[0];
+			*ptr++ = px[1];
+			*ptr++ = px[2];
+		}
+		draw_line(x, (int32_t)y + row, w);
+	}
+	return skip(s, QOI_END_SIZE);
+}
+/*--------------------------------------------------------------------------------------*/
+bool DMD_RGB_Image::decode_bmp(Stream& s, int16_t x, int16_t y) {
+
+	// rest of the file header and the start of BITMAPINFOHEADER:
+	//  0 file size, reserved, offset of the pixels
+	// 12 header size, width, height, planes, bits per pixel, compression
+	uint8_t hdr[32];
+	if (!read(s, hdr, 32)) return false;
+	uint32_t offset = read32(hdr + 8);
+	int32_t w = (int32_t)read32(hdr + 16);
+	int32_t h = (int32_t)read32(hdr + 20);
+	uint8_t bytes = read16(hdr + 26) / 8;
+	// rows go from the bottom up unless the height is negative
+	bool top_down = (h < 0);
+	if (top_down) h = -h;
+	if ((read32(hdr + 12) < 40) || (read32(hdr + 28) != 0) || ((bytes != 3) && (bytes != 4)) ||
+		(w <= 0) || (w > 0xFFFF / 4) || (h > 0xFFFF) || (offset < 34)) return false;
+	img_width = w;
+	img_height = h;
+	if (alloc_line(w * bytes) == NULL) return false;
+	if (!skip(s, offset - 34)) return false;
+
+	// rows are padded to 4 bytes
+	uint8_t pad = (-(w * bytes)) & 0x03;
+	for (uint16_t row = 0; row < h; row++) {
+		if (!read(s, line, w * bytes) || !skip(s, pad)) return false;
+		// BGR or BGRA to RGB in place
+		uint8_t* dst = line;
+		const uint8_t* src = line;
+		for (uint16_t i = 0; i < w; i++) {
+			uint8_t b = src[0];
+			dst[0] = src[2];
+			dst[1] = src[1];
+			dst[2] = b;
+			dst += 3;
+			src += bytes;
+		}
+		draw_line(x, (int32_t)y + (top_down ? row : h - 1 - row), w);
+	}
+	return true;
+}
+/*--------------------------------------------------------------------------------------*/
+bool DMD_RGB_Image::decode_ppm(Stream& s, int16_t x, int16_t y) {
+
+	uint16_t w, h, maxval;
+	if (!read_number(s, w) || !read_number(s, h) || !read_number(s, maxval)) return false;
+	if ((w == 0) || (w > 0xFFFF / 3) || (maxval == 0) || (maxval > 255)) return false;
+	img_width = w;
+	img_height = h;
+	if (alloc_line(w * 3) == NULL) return false;
+
+	for (uint16_t row = 0; row < h; row++) {
+		if (!read(s, line, w * 3)) return false;
+		if (maxval != 255) {
+			for (uint16_t i = 0; i < w * 3; i++) line[i] = (line[i] * 255u) / maxval;
+		}
+		draw_line(x, (int32_t)y + row, w);
+	}
+	return true;
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_Image::draw_line(int16_t x, int32_t y, uint16_t w) {
+
+	if ((y >= 0) && (y < dmd->height())) dmd->drawLine888(x, y, line, w);
+}
+/*--------------------------------------------------------------------------------------*/
+bool DMD_RGB_Image::skip(Stream& s, uint32_t len) {
+
+	uint8_t buf[16];
+	while (len > 0) {
+		uint8_t n = (len > sizeof(buf)) ? sizeof(buf) : len;
+		if (!read(s, buf, n)) return false;
+		len -= n;
+	}
+	return true;
+}
+/*--------------------------------------------------------------------------------------*/
+// The number ends with one whitespace character, which is read too
+bool DMD_RGB_Image::read_number(Stream& s, uint16_t& val) {
+
+	uint8_t c;
+	do {
+		if (!read(s, &c, 1)) return false;
+		if (c == '#') {
+			while (c != '\n') {
+				if (!read(s, &c, 1)) return false;
+			}
+		}
+	} while ((c == ' ') || (c == '\t') || (c == '\r') || (c == '\n'));
+
+	uint32_t n = 0;
+	uint8_t digits = 0;
+	while ((c >= '0') && (c <= '9')) {
+		n = n * 10 + (c - '0');
+		if (n > 0xFFFF) return false;
+		digits++;
+		if (!read(s, &c, 1)) return false;
+	}
+	val = n;
+	return (digits > 0);
+}
+/*--------------------------------------------------------------------------------------*/
+uint8_t* DMD_RGB_Image::alloc_line(uint16_t len) {
+
+	release();
+	line = (uint8_t*)malloc(len);
+	return line;
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_Image::release() {
+
+	free(line);
+	line = NULL;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#ifndef DMD_RGB_IMAGE_H
+#define DMD_RGB_IMAGE_H
+/*--------------------------------------------------------------------------------------
+ This file is a part of the DMD_STM32 library
+
+ DMD_STM32.h  - STM32 port of DMD.h library
+
+ https://github.com/board707/DMD_STM32
+ Dmitry Dmitriev (c) 2019-2023
+/--------------------------------------------------------------------------------------*/
+
+// Streaming image decoder for RGB panels
+
+// Images are read from any Stream (File of SD library, Serial etc.) and drawn
+// to the back buffer line by line through drawLine888(), so only one line
+// of the image is kept in RAM, whatever the image size is.
+// Supported formats, detected by the signature:
+//  QOI - "Quite OK Image" format, 3 or 4 channels, alpha is ignored
+//  BMP - uncompressed 24 or 32 bits per pixel, bottom-up or top-down
+//  PPM - binary P6 with maxval up to 255
+// The image is clipped by the screen edges, but the whole stream is read.
+/*--------------------------------------------------------------------------------------*/
+#include "DMD_RGB.h"
+
+#define IMAGE_NONE  0
+#define IMAGE_QOI   1
+#define IMAGE_BMP   2
+#define IMAGE_PPM   3
+
+class DMD_RGB_Image
+{
+public:
+	DMD_RGB_Image(DMD_RGB_BASE* disp) : dmd(disp) {};
+	~DMD_RGB_Image() { release(); }
+
+	// draw the image with top left corner at (x, y), returns false if the format
+	// is unknown, the data is wrong or the stream ends too early
+	bool draw(Stream& s, int16_t x = 0, int16_t y = 0);
+
+	// parameters of the last image
+	uint8_t getFormat() { return format; }
+	uint16_t getWidth() { return img_width; }
+	uint16_t getHeight() { return img_height; }
+
+protected:
+	// decoders are called after the first two bytes of the signature
+	bool decode_qoi(Stream& s, int16_t x, int16_t y);
+	bool decode_bmp(Stream& s, int16_t x, int16_t y);
+	bool decode_ppm(Stream& s, int16_t x, int16_t y);
+
+	bool read(Stream& s, uint8_t* buf, uint16_t len) { return s.readBytes(buf, len) == len; }
+	bool skip(Stream& s, uint32_t len);
+	// draw the line buffer if the line is on the screen
+	void draw_line(int16_t x, int32_t y, uint16_t w);
+	// number of the PPM header, whitespace and comments before it are skipped
+	bool read_number(Stream& s, uint16_t& val);
+	// line buffer of len bytes
+	uint8_t* alloc_line(uint16_t len);
+	void release();
+
+	static uint16_t read16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+	static uint32_t read32(const uint8_t* p) { return read16(p) | ((uint32_t)read16(p + 2) << 16); }
+	static uint32_t read32_be(const uint8_t* p) {
+		return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | (p[2] << 8) | p[3];
+	}
+
+	DMD_RGB_BASE* dmd;
+	uint8_t* line = NULL;
+	uint8_t format = IMAGE_NONE;
+	uint16_t img_width = 0;
+	uint16_t img_height = 0;
+};
+#endif
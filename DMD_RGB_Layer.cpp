@@ -0,0 +1,72 @@
+/*--------------------------------------------------------------------------------------
+ This file is a part of the library DMD_STM32
+
+ DMD_STM32.h  - STM32 port of DMD.h library
+
+ https://github.com/board707/DMD_STM32
+ Dmitry Dmitriev (c) 2019-2023
+ /--------------------------------------------------------------------------------------*/
+#include "DMD_RGB_Layer.h"
+
+DMD_RGB_Layer::DMD_RGB_Layer(DMD_RGB_BASE* disp, int16_t x, int16_t y, uint16_t w, uint16_t h)
+	: Adafruit_GFX(w, h), DMD_RGB_Sprite(disp, w, h)
+{
+	pos_x = new_x = x;
+	pos_y = new_y = y;
+	visible = true;
+	dirty.clear();
+	prev_dirty.clear();
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_Layer::drawPixel(int16_t x, int16_t y, uint16_t color) {
+	if ((x < 0) || (x >= (int16_t)w) || (y < 0) || (y >= (int16_t)h)) return;
+	setPixel(x, y, color);
+	mark_dirty(x, y, 1, 1);
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_Layer::clear() {
+	memset(tmask, 0, mask_row * h);
+	mark_dirty(0, 0, w, h);
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_Layer::clearRect(int16_t x, int16_t y, int16_t cw, int16_t ch) {
+	for (int16_t yy = y; yy < y + ch; yy++) {
+		for (int16_t xx = x; xx < x + cw; xx++) setTransparent(xx, yy);
+	}
+	mark_dirty(x, y, cw, ch);
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_Layer::mark_dirty(int16_t x, int16_t y, int16_t dw, int16_t dh) {
+	if (x < 0) { dw += x; x = 0; }
+	if (y < 0) { dh += y; y = 0; }
+	if (x + dw > (int16_t)w) dw = w - x;
+	if (y + dh > (int16_t)h) dh = h - y;
+	if ((dw <= 0) || (dh <= 0)) return;
+	if (dirty.isEmpty()) {
+		dirty.set(x, y, dw, dh);
+		return;
+	}
+	// single pixels come here most often
+	if (x < dirty.x0) dirty.x0 = x;
+	if (y < dirty.y0) dirty.y0 = y;
+	if (x + dw > dirty.x1) dirty.x1 = x + dw;
+	if (y + dh > dirty.y1) dirty.y1 = y + dh;
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_Layer::get_update_rect(DMD_Rect& r, bool both_buffers) {
+	r = dirty;
+	// back buffer of the double buffer missed the changes merged to the other one
+	if (both_buffers) r.add(prev_dirty);
+	if (r.isEmpty()) return;
+	r.x0 += pos_x; r.x1 += pos_x;
+	r.y0 += pos_y; r.y1 += pos_y;
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_Layer::blit(const DMD_Rect& r) {
+	int16_t x0 = r.x0 - pos_x, y0 = r.y0 - pos_y;
+	int16_t x1 = r.x1 - pos_x, y1 = r.y1 - pos_y;
+	if (x0 < 0) x0 = 0;
+	if (y0 < 0) y0 = 0;
+	if ((x1 <= x0) || (y1 <= y0)) return;
+	transfer(SPRITE_BLIT, x0, y0, x1, y1);
+}
@@ -0,0 +1,69 @@
+#pragma once
+#ifndef DMD_RGB_LAYER_H
+#define DMD_RGB_LAYER_H
+/*--------------------------------------------------------------------------------------
+ This file is a part of the DMD_STM32 library
+
+ DMD_STM32.h  - STM32 port of DMD.h library
+
+ https://github.com/board707/DMD_STM32
+ Dmitry Dmitriev (c) 2019-2023
+/--------------------------------------------------------------------------------------*/
+
+// Overlay layers for RGB panels
+
+// The screen is a static background plus a few overlay layers.
+// Draw the background into the matrix once and save it by dmd.saveBackground().
+// Overlay layer is a rectangle area with its own buffer and Adafruit GFX
+// drawing methods, register it by dmd.addLayer(). Drawing to the layer doesn't
+// change the screen - the layers are merged to the back buffer at swapBuffers()
+// and only changed rectangles are re-merged: the background is restored
+// under them and the opaque pixels of all layers are drawn over it.
+/*--------------------------------------------------------------------------------------*/
+#include "DMD_RGB_Sprite.h"
+
+// x0,y0 - top left corner, x1,y1 - bottom right, not included
+struct DMD_Rect {
+	int16_t x0, y0, x1, y1;
+
+	bool isEmpty() const { return (x0 >= x1) || (y0 >= y1); }
+	void clear() { x0 = y0 = 0; x1 = y1 = 0; }
+	void set(int16_t x, int16_t y, int16_t w, int16_t h) { x0 = x; y0 = y; x1 = x + w; y1 = y + h; }
+	void add(const DMD_Rect& r) {
+		if (r.isEmpty()) return;
+		if (isEmpty()) { *this = r; return; }
+		if (r.x0 < x0) x0 = r.x0;
+		if (r.y0 < y0) y0 = r.y0;
+		if (r.x1 > x1) x1 = r.x1;
+		if (r.y1 > y1) y1 = r.y1;
+	}
+};
+/*--------------------------------------------------------------------------------------*/
+class DMD_RGB_Layer : public Adafruit_GFX, protected DMD_RGB_Sprite
+{
+	friend class DMD_RGB_BASE;
+public:
+	// layer of w * h pixels at x,y of the screen, transparent after creation
+	DMD_RGB_Layer(DMD_RGB_BASE* disp, int16_t x, int16_t y, uint16_t w, uint16_t h);
+
+	using Adafruit_GFX::width;
+	using Adafruit_GFX::height;
+
+	// drawing in the layer coordinates
+	void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+	// make all the layer or its part transparent
+	void clear();
+	void clearRect(int16_t x, int16_t y, int16_t w, int16_t h);
+
+protected:
+	void mark_dirty(int16_t x, int16_t y, int16_t w, int16_t h);
+	// screen area to re-merge at the next swapBuffers()
+	void get_update_rect(DMD_Rect& r, bool both_buffers);
+	// draw the opaque pixels inside the screen rectangle
+	void blit(const DMD_Rect& r);
+
+	DMD_Rect dirty;             // changed since last merge, in layer coordinates
+	DMD_Rect prev_dirty;        // merged to the other buffer of double buffer
+	DMD_RGB_Layer* next = NULL;
+};
+#endif
@@ -0,0 +1,137 @@
+/*--------------------------------------------------------------------------------------
+ This file is a part of the library DMD_STM32
+
+ DMD_STM32.h  - STM32 port of DMD.h library
+
+ https://github.com/board707/DMD_STM32
+ Dmitry Dmitriev (c) 2019-2023
+ /--------------------------------------------------------------------------------------*/
+#include "DMD_RGB_Sprite.h"
+
+DMD_RGB_Sprite::DMD_RGB_Sprite(DMD_RGB_BASE* disp, uint16_t _w, uint16_t _h)
+	: dmd(disp), w(_w), h(_h)
+{
+	col_bytes = dmd->col_bytes_cnt;
+	mask_row = (w + 7) / 8;
+	image = (uint8_t*)malloc(w * h * col_bytes);
+	save_buf = (uint8_t*)malloc(w * h * col_bytes);
+	tmask = (uint8_t*)malloc(mask_row * h);
+	// fully transparent until the image is loaded
+	memset(tmask, 0, mask_row * h);
+}
+/*--------------------------------------------------------------------------------------*/
+DMD_RGB_Sprite::~DMD_RGB_Sprite()
+{
+	free(image);
+	free(save_buf);
+	free(tmask);
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_Sprite::setBitmap(const uint16_t* bitmap, uint16_t transparent_color) {
+	for (uint16_t y = 0; y < h; y++) {
+		for (uint16_t x = 0; x < w; x++) {
+			uint16_t c = bitmap[y * w + x];
+			if (c == transparent_color) setTransparent(x, y);
+			else setPixel(x, y, c);
+		}
+	}
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_Sprite::setPixel(int16_t x, int16_t y, uint16_t color) {
+	if ((x < 0) || (x >= w) || (y < 0) || (y >= h)) return;
+	// color bytes hold the color for both halves of the panel,
+	// the half is selected by the mask when the sprite is drawn
+	dmd->getColorBytes(image + (y * w + x) * col_bytes, color);
+	tmask[y * mask_row + x / 8] |= (0x80 >> (x % 8));
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_Sprite::setTransparent(int16_t x, int16_t y) {
+	if ((x < 0) || (x >= w) || (y < 0) || (y >= h)) return;
+	tmask[y * mask_row + x / 8] &= ~(0x80 >> (x % 8));
+}
+/*--------------------------------------------------------------------------------------*/
+// Walk through the opaque pixels of the sprite at its screen position
+// and save, restore or draw their color bytes in all planes
+void DMD_RGB_Sprite::transfer(uint8_t op, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
+
+	int16_t scr_w = dmd->width();
+	int16_t scr_h = dmd->height();
+	uint16_t displ_len = dmd->displ_len;
+	if (x1 > w) x1 = w;
+	if (y1 > h) y1 = h;
+
+	for (uint16_t sy = y0; sy < y1; sy++) {
+		int16_t y = pos_y + sy;
+		if (y < 0) continue;
+		if (y >= scr_h) break;
+
+		// visible part of the sprite line
+		int16_t sx0 = (pos_x + (int16_t)x0 < 0) ? -pos_x : x0;
+		int16_t sx1 = (pos_x + (int16_t)x1 > scr_w) ? scr_w - pos_x : x1;
+		uint8_t* ptr = NULL;
+		int16_t step = 0;
+		const uint8_t* mask = NULL;
+		uint16_t run = 0;
+
+		for (int16_t sx = sx0; sx < sx1; sx++) {
+			// the line is walked by the runs of consecutive bytes in the buffer
+			if (run == 0) {
+				uint16_t addr;
+				bool lower;
+				run = dmd->get_line_run(pos_x + sx, y, sx1 - sx, addr, step, lower);
+				ptr = dmd->matrixbuff[dmd->backindex] + addr;
+				mask = dmd->getColorByteMask(lower);
+			}
+			else ptr += step;
+			run--;
+
+			if (!is_opaque(sx, sy)) continue;
+
+			uint32_t idx = ((uint32_t)sy * w + sx) * col_bytes;
+			uint8_t* p = ptr;
+			for (uint8_t b = 0; b < col_bytes; b++) {
+				switch (op) {
+				case SPRITE_SAVE:
+					save_buf[idx + b] = *p & mask[b];
+					break;
+				case SPRITE_RESTORE:
+					*p = (*p & ~mask[b]) | save_buf[idx + b];
+					break;
+				default:
+					*p = (*p & ~mask[b]) | (image[idx + b] & mask[b]);
+					break;
+				}
+				p += displ_len;
+			}
+		}
+	}
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_Sprite::show(int16_t x, int16_t y) {
+	if (visible) transfer(SPRITE_RESTORE);
+	pos_x = new_x = x;
+	pos_y = new_y = y;
+	transfer(SPRITE_SAVE);
+	transfer(SPRITE_BLIT);
+	visible = true;
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_Sprite::hide() {
+	if (!visible) return;
+	transfer(SPRITE_RESTORE);
+	visible = false;
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_Sprite::moveTo(int16_t x, int16_t y) {
+	show(x, y);
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_Sprite::update(DMD_RGB_Sprite** sprites, uint8_t cnt) {
+	for (uint8_t i = cnt; i > 0; i--) {
+		sprites[i - 1]->redraw = sprites[i - 1]->visible;
+		sprites[i - 1]->hide();
+	}
+	for (uint8_t i = 0; i < cnt; i++) {
+		if (sprites[i]->redraw) sprites[i]->show(sprites[i]->new_x, sprites[i]->new_y);
+	}
+}
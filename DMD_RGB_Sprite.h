@@ -0,0 +1,78 @@
+#pragma once
+#ifndef DMD_RGB_SPRITE_H
+#define DMD_RGB_SPRITE_H
+/*--------------------------------------------------------------------------------------
+ This file is a part of the DMD_STM32 library
+
+ DMD_STM32.h  - STM32 port of DMD.h library
+
+ https://github.com/board707/DMD_STM32
+ Dmitry Dmitriev (c) 2019-2023
+/--------------------------------------------------------------------------------------*/
+
+// Sprites for RGB panels
+
+// The sprite image is kept in the color bytes of the matrix buffer planes
+// with 1-bit transparency mask. Before drawing the sprite saves the buffer
+// bytes under its opaque pixels, so it can be moved or hidden without
+// redrawing the rest of the screen - the cost is proportional to the sprite area.
+//
+// Sprites are drawn to the back buffer. In double buffer mode update them
+// and then call swapBuffers(true), so the new back buffer keeps them too.
+/*--------------------------------------------------------------------------------------*/
+#include "DMD_RGB.h"
+
+class DMD_RGB_Sprite
+{
+public:
+	DMD_RGB_Sprite(DMD_RGB_BASE* disp, uint16_t w, uint16_t h);
+	~DMD_RGB_Sprite();
+
+	// load image from 5-6-5 bitmap of w * h pixels, pixels of transparent_color are not drawn
+	// (change the image of the hidden sprite only - save-under keeps opaque pixels only)
+	void setBitmap(const uint16_t* bitmap, uint16_t transparent_color);
+	void setPixel(int16_t x, int16_t y, uint16_t color);
+	void setTransparent(int16_t x, int16_t y);
+
+	// save the screen under the sprite and draw it at x,y
+	void show(int16_t x, int16_t y);
+	// restore the screen under the sprite
+	void hide();
+	// restore the old place, draw at the new one
+	void moveTo(int16_t x, int16_t y);
+	// set position for the next update()
+	void setPosition(int16_t x, int16_t y) { new_x = x; new_y = y; }
+
+	// Redraw the group of sprites in one frame: all visible sprites
+	// are hidden in reverse order and then drawn at new positions,
+	// so overlapping sprites restore the screen correctly.
+	// Hidden sprites stay hidden, show() puts them on the screen
+	static void update(DMD_RGB_Sprite** sprites, uint8_t cnt);
+
+	int16_t getX() { return pos_x; }
+	int16_t getY() { return pos_y; }
+	bool isVisible() { return visible; }
+	uint16_t width() { return w; }
+	uint16_t height() { return h; }
+
+protected:
+	enum { SPRITE_SAVE, SPRITE_RESTORE, SPRITE_BLIT };
+	// x0,y0 - x1,y1 : part of the sprite to process, x1 and y1 not included
+	void transfer(uint8_t op, uint16_t x0 = 0, uint16_t y0 = 0, uint16_t x1 = 0xFFFF, uint16_t y1 = 0xFFFF);
+	bool is_opaque(uint16_t x, uint16_t y) {
+		return tmask[y * mask_row + x / 8] & (0x80 >> (x % 8));
+	}
+
+	DMD_RGB_BASE* dmd;
+	uint16_t w, h;
+	uint8_t col_bytes;          // color bytes per pixel, one for every plane
+	uint16_t mask_row;          // bytes of transparency mask row
+	uint8_t* image;             // w * h * col_bytes
+	uint8_t* tmask;             // 1 - opaque pixel
+	uint8_t* save_buf;          // w * h * col_bytes, matrix bytes under the sprite
+	int16_t pos_x = 0, pos_y = 0;
+	int16_t new_x = 0, new_y = 0;
+	bool visible = false;
+	bool redraw = false;        // visible before update()
+};
+#endif
@@ -0,0 +1,157 @@
+/*--------------------------------------------------------------------------------------
+ This file is a part of the library DMD_STM32
+
+ DMD_STM32.h  - STM32 port of DMD.h library
+
+ https://github.com/board707/DMD_STM32
+ Dmitry Dmitriev (c) 2019-2023
+ /--------------------------------------------------------------------------------------*/
+#include "DMD_RGB_Transition.h"
+
+// 8x8 ordered dither thresholds, pixels of the new screen appear in this order
+static const uint8_t dissolve_order[8][8] = {
+	{  0, 32,  8, 40,  2, 34, 10, 42 },
+	{ 48, 16, 56, 24, 50, 18, 58, 26 },
+	{ 12, 44,  4, 36, 14, 46,  6, 38 },
+	{ 60, 28, 52, 20, 62, 30, 54, 22 },
+	{  3, 35, 11, 43,  1, 33,  9, 41 },
+	{ 51, 19, 59, 27, 49, 17, 57, 25 },
+	{ 15, 47,  7, 39, 13, 45,  5, 37 },
+	{ 63, 31, 55, 23, 61, 29, 53, 21 }
+};
+/*--------------------------------------------------------------------------------------*/
+bool DMD_RGB_Transition::begin(uint8_t type, uint16_t duration) {
+	if (dmd->matrixbuff[0] == dmd->matrixbuff[1]) return false;
+	release();
+	uint16_t size = dmd->mem_Buffer_Size;
+	own_buf = (uint8_t*)malloc(size * 2ul);
+	if (own_buf == NULL) return false;
+	memcpy(own_buf, dmd->matrixbuff[1 - dmd->backindex], size);
+	memcpy(own_buf + size, dmd->matrixbuff[dmd->backindex], size);
+	return begin(type, duration, own_buf, own_buf + size);
+}
+/*--------------------------------------------------------------------------------------*/
+bool DMD_RGB_Transition::begin(uint8_t type, uint16_t duration, const uint8_t* from, const uint8_t* to) {
+	// buffers of the previous front/back transition aren't used anymore,
+	// unless begin(type, duration) passes them here
+	if (own_buf != NULL) {
+		const uint8_t* own_end = own_buf + dmd->mem_Buffer_Size * 2ul;
+		bool from_own = (from >= own_buf) && (from < own_end);
+		bool to_own = (to >= own_buf) && (to < own_end);
+		if (!from_own && !to_own) release();
+	}
+	this->type = type;
+	this->duration = duration;
+	from_buf = from;
+	to_buf = to;
+	last_progress = 0xFFFF;
+	start_frame = dmd->getFrameCount();
+	running = true;
+	return true;
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_Transition::release() {
+	free(own_buf);
+	own_buf = NULL;
+}
+/*--------------------------------------------------------------------------------------*/
+bool DMD_RGB_Transition::update() {
+	if (!running) return false;
+
+	uint32_t t = dmd->getFrameCount() - start_frame;
+	if (t >= duration) {
+		// the last frame goes to both buffers
+		memcpy(dmd->matrixbuff[dmd->backindex], to_buf, dmd->mem_Buffer_Size);
+		dmd->swapBuffers(true);
+		running = false;
+		release();
+		return false;
+	}
+	uint16_t progress = (t * 256) / duration;
+	if (progress != last_progress) {
+		last_progress = progress;
+		// back buffer is rebuilt completely, so no copy at swap
+		draw_frame(progress);
+		dmd->swapBuffers(false);
+	}
+	return true;
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_Transition::draw_frame(uint16_t progress) {
+	int16_t w = dmd->width();
+	int16_t h = dmd->height();
+	int16_t dx = ((int32_t)w * progress) >> 8;
+	int16_t dy = ((int32_t)h * progress) >> 8;
+
+	switch (type) {
+	case TRANSITION_WIPE_LEFT:
+		// new screen comes from the right edge
+		for (int16_t y = 0; y < h; y++) {
+			copy_line(0, y, from_buf, 0, y, w - dx);
+			copy_line(w - dx, y, to_buf, w - dx, y, dx);
+		}
+		break;
+	case TRANSITION_WIPE_RIGHT:
+		for (int16_t y = 0; y < h; y++) {
+			copy_line(0, y, to_buf, 0, y, dx);
+			copy_line(dx, y, from_buf, dx, y, w - dx);
+		}
+		break;
+	case TRANSITION_WIPE_UP:
+		for (int16_t y = 0; y < h; y++) {
+			copy_line(0, y, (y < h - dy) ? from_buf : to_buf, 0, y, w);
+		}
+		break;
+	case TRANSITION_WIPE_DOWN:
+		for (int16_t y = 0; y < h; y++) {
+			copy_line(0, y, (y < dy) ? to_buf : from_buf, 0, y, w);
+		}
+		break;
+	case TRANSITION_SLIDE_LEFT:
+		// both screens move, the new one pushes the old one out
+		for (int16_t y = 0; y < h; y++) {
+			copy_line(0, y, from_buf, dx, y, w - dx);
+			copy_line(w - dx, y, to_buf, 0, y, dx);
+		}
+		break;
+	case TRANSITION_SLIDE_RIGHT:
+		for (int16_t y = 0; y < h; y++) {
+			copy_line(0, y, to_buf, w - dx, y, dx);
+			copy_line(dx, y, from_buf, 0, y, w - dx);
+		}
+		break;
+	case TRANSITION_SLIDE_UP:
+		for (int16_t y = 0; y < h; y++) {
+			if (y < h - dy) copy_line(0, y, from_buf, 0, y + dy, w);
+			else copy_line(0, y, to_buf, 0, y - (h - dy), w);
+		}
+		break;
+	case TRANSITION_SLIDE_DOWN:
+		for (int16_t y = 0; y < h; y++) {
+			if (y < dy) copy_line(0, y, to_buf, 0, y + (h - dy), w);
+			else copy_line(0, y, from_buf, 0, y - dy, w);
+		}
+		break;
+	default: {
+		// TRANSITION_DISSOLVE
+		uint8_t level = progress >> 2;
+		for (int16_t y = 0; y < h; y++) {
+			const uint8_t* order = dissolve_order[y & 7];
+			int16_t x = 0;
+			// runs of pixels from the same screen
+			while (x < w) {
+				bool is_new = order[x & 7] < level;
+				int16_t x1 = x + 1;
+				while ((x1 < w) && ((order[x1 & 7] < level) == is_new)) x1++;
+				copy_line(x, y, is_new ? to_buf : from_buf, x, y, x1 - x);
+				x = x1;
+			}
+		}
+		break;
+	}
+	}
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD_RGB_Transition::copy_line(int16_t xd, int16_t yd, const uint8_t* src, int16_t xs, int16_t ys, int16_t len) {
+	if (len > 0) dmd->move_line(dmd->matrixbuff[dmd->backindex], xd, yd, src, xs, ys, len);
+}
@@ -0,0 +1,65 @@
+#pragma once
+#ifndef DMD_RGB_TRANSITION_H
+#define DMD_RGB_TRANSITION_H
+/*--------------------------------------------------------------------------------------
+ This file is a part of the DMD_STM32 library
+
+ DMD_STM32.h  - STM32 port of DMD.h library
+
+ https://github.com/board707/DMD_STM32
+ Dmitry Dmitriev (c) 2019-2023
+/--------------------------------------------------------------------------------------*/
+
+// Screen transitions for RGB panels
+
+// Intermediate frames are built from two screens in the matrix buffer format
+// by copying of line runs, without redrawing the screens.
+// In double buffer mode begin(type, duration) makes transition from the shown
+// screen to the one drawn in the back buffer (two temporary buffers are allocated).
+// Prepared buffers of mem_Buffer_Size bytes can be passed to begin() as well.
+// The duration is counted in the screen refresh cycles, call update() from loop().
+/*--------------------------------------------------------------------------------------*/
+#include "DMD_RGB.h"
+
+#define TRANSITION_WIPE_LEFT    0
+#define TRANSITION_WIPE_RIGHT   1
+#define TRANSITION_WIPE_UP      2
+#define TRANSITION_WIPE_DOWN    3
+#define TRANSITION_SLIDE_LEFT   4
+#define TRANSITION_SLIDE_RIGHT  5
+#define TRANSITION_SLIDE_UP     6
+#define TRANSITION_SLIDE_DOWN   7
+#define TRANSITION_DISSOLVE     8
+
+class DMD_RGB_Transition
+{
+public:
+	DMD_RGB_Transition(DMD_RGB_BASE* disp) : dmd(disp) {};
+	~DMD_RGB_Transition() { release(); }
+
+	// from the front buffer to the back buffer, double buffer mode only
+	bool begin(uint8_t type, uint16_t duration);
+	// between two prepared buffers
+	bool begin(uint8_t type, uint16_t duration, const uint8_t* from, const uint8_t* to);
+	// call it from loop(), returns false when the transition is over
+	bool update();
+	bool isRunning() { return running; }
+
+protected:
+	// build the frame of the transition, progress 0..256
+	void draw_frame(uint16_t progress);
+	// copy len pixels of the line from the source screen to the back buffer
+	void copy_line(int16_t xd, int16_t yd, const uint8_t* src, int16_t xs, int16_t ys, int16_t len);
+	void release();
+
+	DMD_RGB_BASE* dmd;
+	const uint8_t* from_buf = NULL;
+	const uint8_t* to_buf = NULL;
+	uint8_t* own_buf = NULL;        // buffers allocated by begin()
+	uint8_t type = TRANSITION_WIPE_LEFT;
+	uint16_t duration = 0;
+	uint16_t last_progress = 0xFFFF;
+	uint32_t start_frame = 0;
+	bool running = false;
+};
+#endif
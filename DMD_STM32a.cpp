@@ -64,6 +64,7 @@ DMD::DMD(DMD_Pinlist* _mux_pinlist, byte _pin_nOE, byte _pin_SCLK, byte panelsWi
 DMD::~DMD()
 {
 	free(mux_mask2);
+	free(tile_table);
 	delete mux_pinlist;
 	delete data_pinlist;
 #if defined(DEBUG2)
@@ -313,6 +314,7 @@ void DMD::switch_row() {
 	this->set_mux(bDMDByte);
 
 	if (bDMDByte == 2) {
+		frame_count++;
 		if (swapflag == true) {    // Swap front/back buffers if requested
 			backindex = 1 - backindex;
 			swapflag = false;
@@ -367,6 +369,118 @@ void DMD::transform_XY(int16_t& bX, int16_t& bY) {
 		bY = row * DMD_PIXELS_DOWN + bY;
 
 	}
+	else if ((connectScheme == CONNECT_TILEMAP) && (tile_table != NULL)) {
+		int16_t lx = bX % DMD_PIXELS_ACROSS;
+		int16_t ly = bY % DMD_PIXELS_DOWN;
+		const DMD_Tile_Transform& t = tile_table[row * DisplaysWide + bX / DMD_PIXELS_ACROSS];
+
+		switch (t.rotation) {
+		case 1:
+			_swap_int16_t(lx, ly);
+			lx = DMD_PIXELS_ACROSS - 1 - lx;
+			break;
+		case 2:
+			lx = DMD_PIXELS_ACROSS - 1 - lx;
+			ly = DMD_PIXELS_DOWN - 1 - ly;
+			break;
+		case 3:
+			_swap_int16_t(lx, ly);
+			ly = DMD_PIXELS_DOWN - 1 - ly;
+			break;
+		}
+		bX = (t.panel % DisplaysWide) * DMD_PIXELS_ACROSS + lx;
+		bY = (t.panel / DisplaysWide) * DMD_PIXELS_DOWN + ly;
+	}
+}
+/*--------------------------------------------------------------------------------------*/
+bool DMD::setTileMap(const DMD_Panel_Tile* map) {
+
+	if (map == NULL) {
+		setConnectScheme(CONNECT_NORMAL);
+		return (connectScheme == CONNECT_NORMAL);
+	}
+	DMD_Tile_Transform* table = (DMD_Tile_Transform*)malloc(DisplaysTotal * 2 * sizeof(DMD_Tile_Transform));
+	if (table == NULL) return false;
+	DMD_Tile_Transform* by_buffer = table + DisplaysTotal;
+	// every screen position must be taken once
+	for (uint8_t i = 0; i < DisplaysTotal; i++) table[i].panel = 0xFF;
+
+	for (uint8_t i = 0; i < DisplaysTotal; i++) {
+		const DMD_Panel_Tile& tile = map[i];
+		uint8_t pos = tile.y * DisplaysWide + tile.x;
+		if ((tile.x >= DisplaysWide) || (tile.y >= DisplaysHigh) || (tile.rotation > 3) ||
+			((tile.rotation & 1) && (DMD_PIXELS_ACROSS != DMD_PIXELS_DOWN)) || (table[pos].panel != 0xFF)) {
+			free(table);
+			return false;
+		}
+		table[pos].panel = i;
+		table[pos].rotation = tile.rotation;
+		by_buffer[i].panel = pos;
+		by_buffer[i].rotation = tile.rotation;
+	}
+	free(tile_table);
+	tile_table = table;
+	setConnectScheme(CONNECT_TILEMAP);
+	return (connectScheme == CONNECT_TILEMAP);
+}
+/*--------------------------------------------------------------------------------------*/
+bool DMD::clip_run(int16_t& x, int16_t& y, uint8_t& hbyte, uint16_t& bsize, bool vertical) {
+
+	if ((hbyte != 0xff) && (bsize > 8)) bsize = 8;
+	int16_t& pos = vertical ? y : x;
+	int16_t& cross = vertical ? x : y;
+	int16_t len = vertical ? _height : _width;
+	int16_t cross_len = vertical ? _width : _height;
+
+	//if whole line is outside - go out
+	if (((pos + bsize) <= 0) || (pos >= len) || (cross < 0) || (cross >= cross_len)) return false;
+
+	//if start of line before 0 - draw portion of line from 0
+	if (pos < 0) {
+		bsize = bsize + pos;
+		if (hbyte != 0xff) hbyte <<= (pos * -1);
+		pos = 0;
+	}
+
+	//if end of line after the edge of screen - draw until the edge
+	if ((pos + bsize) > len) bsize = len - pos;
+	return true;
+}
+/*--------------------------------------------------------------------------------------*/
+// The screen X axis goes in the buffer to the right, down, left or up for rotation 0..3,
+// Y axis is turned one more quarter. Odd panel rows of zigzag are turned by 180 degrees,
+// panels of the tiling map are turned by their own rotation.
+uint16_t DMD::line_run(int16_t x, int16_t y, uint8_t& dir, bool vertical) {
+
+	dir = (rotation + vertical) & 3;
+	// the buffer line goes through the panels in order of the screen, except of the tiling map
+	int16_t line_x = x;
+	int16_t line_w = WIDTH;
+	if ((connectScheme == CONNECT_ZIGZAG) && ((y / DMD_PIXELS_DOWN) % 2)) dir ^= 2;
+	else if ((connectScheme == CONNECT_TILEMAP) && (tile_table != NULL)) {
+		uint8_t panel = (y / DMD_PIXELS_DOWN) * DisplaysWide + x / DMD_PIXELS_ACROSS;
+		dir = (dir + tile_table[DisplaysTotal + panel].rotation) & 3;
+		line_x = x % DMD_PIXELS_ACROSS;
+		line_w = DMD_PIXELS_ACROSS;
+	}
+
+	switch (dir) {
+	case 0:
+		return line_w - line_x;
+	case 1:
+		return DMD_PIXELS_DOWN - y % DMD_PIXELS_DOWN;
+	case 2:
+		return line_x + 1;
+	default:
+		return y % DMD_PIXELS_DOWN + 1;
+	}
+}
+/*--------------------------------------------------------------------------------------*/
+int8_t DMD::buffer_shift(int8_t step, bool& across, bool vertical) {
+
+	uint8_t dir = (rotation + vertical) & 3;
+	across = dir & 1;
+	return (dir & 2) ? -step : step;
 }
 
 
@@ -468,35 +582,59 @@ uint8_t DMD::stepMarquee(int amountX, int amountY, byte orientation)
 	if ((marqueeOffsetX + marqueeWidth) == DMD_PIXELS_ACROSS * DisplaysWide) {
 		ret |= 4;
 	}
-	// Special case horizontal scrolling to improve speed
-	if (amountY == 0 && use_shift &&
-		((amountX == -1) || (amountX == 1))) {
-		// Shift entire screen one pixel
+	// Special case horizontal scrolling to improve speed,
+	// the step must fit in shiftScreen(int8_t) and the screen width
+	if (amountY == 0 && use_shift && (amountX != 0) &&
+		(amountX > -127) && (amountX < 127) && (amountX > -_width) && (amountX < _width)) {
+		// Shift entire screen by amountX pixels
 		shiftScreen(amountX);
 
-		uint16_t limit_X = 0;                 // if (amountX == 1)
-		if (amountX == -1) {  // if (amountX == -1)
-			limit_X = _width;
-			if (marqueeOffsetX < (_width - marqueeWidth)) return ret;
+		// Screen columns [limit_L, limit_R) came in from the edge
+		int16_t limit_L = 0;                 // if (amountX > 0)
+		int16_t limit_R = amountX;
+		if (amountX < 0) {
+			limit_L = _width + amountX;
+			limit_R = _width;
+			if (marqueeOffsetX + marqueeWidth <= limit_L) return ret;
 		}
 		else {
-			if (marqueeOffsetX > 0) return ret;
+			if (marqueeOffsetX >= limit_R) return ret;
 		}
-		// Redraw last char on screen
+		// Redraw chars crossing the new columns
 		int strWidth = marqueeOffsetX;
 		for (int i = 0; i < marqueeLength; i++) {
+			if (strWidth >= limit_R) break;
 			int wide = charWidth(marqueeText[i], orientation);
 			if (wide > 0) {
-				if (strWidth + wide >= limit_X) {
+				if (strWidth + wide > limit_L) {
 					uint16_t curr_color = get_marquee_text_color(i);
 					this->drawChar(strWidth, marqueeOffsetY, marqueeText[i], curr_color, marqueeMarginH, marqueeMarginL, orientation);
-					return ret;
 				}
 				strWidth += wide + 1;
 			}
 		}
 
 	}
+	// Special case vertical scrolling
+	else if (amountX == 0 && use_shift &&
+		((amountY == -1) || (amountY == 1))) {
+		// Shift entire screen one pixel
+		shiftScreenVertical(amountY);
+
+		// Redraw the text only if it crosses the row came in from the screen edge
+		int16_t limit_Y = 0;                 // if (amountY == 1)
+		if (amountY == -1) limit_Y = _height - 1;
+		int16_t text_top = marqueeOffsetY;
+		int16_t text_bottom = marqueeOffsetY + marqueeHeight;
+		if (!orientation) {
+			text_top += marqueeMarginH;
+			text_bottom = marqueeOffsetY + marqueeMarginL;
+		}
+		if ((limit_Y >= text_top) && (limit_Y <= text_bottom)) {
+			this->drawMarqueeString(marqueeOffsetX, marqueeOffsetY, marqueeText, marqueeLength,
+				marqueeMarginH, marqueeMarginL, orientation);
+		}
+	}
 	else {
 
 		if (amountY > 0)	drawFilledBox(marqueeOffsetX, old_y + marqueeMarginH,
@@ -552,6 +690,52 @@ void DMD::drawFilledBox(int x1, int y1, int x2, int y2,
 		drawFastHLine(x1, b, (x2 - x1) + 1, color);
 	}
 }
+/*--------------------------------------------------------------------------------------*/
+void DMD::drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color) {
+	draw_bitmap(x, y, bitmap, w, h, color, 0, true);
+}
+/*--------------------------------------------------------------------------------------*/
+void DMD::drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color,
+	uint16_t bg) {
+	draw_bitmap(x, y, bitmap, w, h, color, bg, false);
+}
+/*--------------------------------------------------------------------------------------*/
+// Every byte of the row is one drawHByte() call,
+// the bytes of all pixels set (or clear) go as one solid run
+void DMD::draw_bitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t color,
+	uint16_t bg, bool transparent) {
+
+	if (!fast_Hbyte) {
+		if (transparent) Adafruit_GFX::drawBitmap(x, y, bitmap, w, h, color);
+		else Adafruit_GFX::drawBitmap(x, y, bitmap, w, h, color, bg);
+		return;
+	}
+	uint8_t fg_col_bytes[4];
+	uint8_t bg_col_bytes[4];
+	getColorBytes(fg_col_bytes, color);
+	getColorBytes(bg_col_bytes, bg);
+	int16_t byte_width = (w + 7) / 8;
+
+	for (int16_t yy = y; yy < y + h; yy++, bitmap += byte_width) {
+		if ((yy < 0) || (yy >= _height)) continue;
+		int16_t i = 0;
+		while (i < byte_width) {
+			uint8_t bits = pgm_read_byte(&bitmap[i]);
+			int16_t i1 = i + 1;
+			if ((bits == 0xff) || (bits == 0)) {
+				while ((i1 < byte_width) && (pgm_read_byte(&bitmap[i1]) == bits)) i1++;
+				int16_t len = ((i1 * 8 < w) ? i1 * 8 : w) - i * 8;
+				if (bits) drawHByte(x + i * 8, yy, 0xff, len, fg_col_bytes, fg_col_bytes);
+				else if (!transparent) drawHByte(x + i * 8, yy, 0xff, len, bg_col_bytes, bg_col_bytes);
+			}
+			else {
+				int16_t len = ((i1 * 8 < w) ? i1 * 8 : w) - i * 8;
+				drawHByte(x + i * 8, yy, bits, len, fg_col_bytes, transparent ? NULL : bg_col_bytes);
+			}
+			i = i1;
+		}
+	}
+}
 
 /*--------------------------------------------------------------------------------------
 	   Select current font
@@ -73,6 +73,20 @@ typedef uint16_t PortType;
 #define GRAPHICS_TOGGLE    2
 #define GRAPHICS_OR        3
 #define GRAPHICS_NOR       4
+#define GRAPHICS_AND       5
+
+// Raster operation of the graphics mode, resolved once per drawing primitive.
+// Works on the bits of "on" pixels: d - destination, s - source, m - bits to change.
+// d = ((d & ~clr) | set) ^ flip, where clr, set and flip are selected from s or ~s
+struct DMD_RasterOp {
+	uint16_t clr_s, clr_ns, set_s, set_ns, flip_s;
+
+	uint16_t apply(uint16_t d, uint16_t s, uint16_t m) const {
+		uint16_t ns = ~s & m;
+		s &= m;
+		return ((d & ~((s & clr_s) | (ns & clr_ns))) | (s & set_s) | (ns & set_ns)) ^ (s & flip_s);
+	}
+};
 
 //Panel inverse mode (for some panels)
 #define PANEL_INVERSE 0
@@ -94,6 +108,13 @@ typedef uint16_t PortType;
 #define CONNECT_NORMAL 0
 #define CONNECT_ROTATE90 1
 #define CONNECT_ZIGZAG 2
+#define CONNECT_TILEMAP 3
+
+// Panel of the tiling map, see DMD::setTileMap()
+struct DMD_Panel_Tile {
+	uint8_t x, y;          // position of the panel on the screen, in panels
+	uint8_t rotation;      // 0..3 - clockwise turn of the panel, 1 and 3 for square panels only
+};
 
 // Shift marquee result codes
 #define MARQUEE_OUT_OF_SCREEN 1					// text has left the screen
@@ -155,6 +176,8 @@ public:
 	virtual void clearScreen(byte bNormal);
 	virtual void fillScreen(uint16_t color);
 	virtual void shiftScreen(int8_t step) = 0;
+	//Shift entire screen one pixel up (step < 0) or down (step > 0)
+	virtual void shiftScreenVertical(int8_t step) = 0;
 	virtual void transform_XY(int16_t& x, int16_t& y);
 	
 	
@@ -288,26 +311,27 @@ public:
 	// Default method to scrolling the marquee is shifting of whole screen.
 	// Set this flag (true) to avoid this if you need to display more than one string at time.
 	virtual void disableFastTextShift(bool shift) {
-		if ((!shift) && (this->connectScheme == CONNECT_NORMAL)) this->use_shift = true;
+		if ((!shift) && ((this->connectScheme == CONNECT_NORMAL) || this->connect_shift)) this->use_shift = true;
 		else this->use_shift = false;
 	}
 
 	// set panel connection scheme
 	virtual void setConnectScheme(uint8_t sch) {
 		this->connectScheme = sch;
-		if (sch != CONNECT_NORMAL) {
+		if ((sch != CONNECT_NORMAL) && (!this->connect_shift)) {
 			this->use_shift = false;
-			this->fast_Hbyte = false;
 		}
 	};
+	// Set the arbitrary panel tiling map, one entry for every panel in order of the buffer:
+	// row by row of panelsWide panels, as they are shown with CONNECT_NORMAL.
+	// The map is compiled to the table of panel transforms, so the map array may be temporary.
+	// Returns false if the map is wrong or the driver doesn't allow to change connect scheme,
+	// setTileMap(NULL) returns to CONNECT_NORMAL
+	bool setTileMap(const DMD_Panel_Tile* map);
 	// rotate the screen
+	// Byte runs and the screen shift follow the rotation, so they are kept
 	virtual void setRotation(uint8_t x) {
-		uint8_t rot = (x & 3);
-		if (rot) {
-			this->use_shift = false;
-			this->fast_Hbyte = false;
-		}
-		Adafruit_GFX::setRotation(rot);
+		Adafruit_GFX::setRotation(x & 3);
 	};
 
 
@@ -315,6 +339,13 @@ public:
 	//Draw or clear a filled box(rectangle) with a single pixel border
 	void drawFilledBox(int x1, int y1, int x2, int y2, uint16_t color);
 
+	// 1-bit bitmaps in Adafruit_GFX format (rows of MSB first bytes) are drawn by byte runs,
+	// without bg color the background is transparent
+	using Adafruit_GFX::drawBitmap;
+	void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color);
+	void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color,
+		uint16_t bg);
+
 	//Set brightness of panel ( 0 - 255)
 	virtual void setBrightness(uint8_t level) {
 		this->brightness = level;
@@ -326,6 +357,9 @@ public:
 	//Exchange drawing and output buffers (in dual_buf mode)
 	virtual void swapBuffers(boolean copy);
 
+	//Number of screen refresh cycles since start, for pacing of animations
+	inline uint32_t getFrameCount() { return this->frame_count; };
+
 #if defined(DEBUG2)
 	void dumpDDbuf(void);
 	void dumpMatrix(void);
@@ -345,8 +379,28 @@ protected:
 #endif
 	virtual void generate_muxmask();
 	virtual void set_mux(uint8_t curr_row);
+	// bg_col_bytes = NULL makes zero bits transparent
 	virtual void drawHByte(int16_t x, int16_t y, uint8_t hbyte, uint16_t bsize, uint8_t* fg_col_bytes,
 		uint8_t* bg_col_bytes) {} ;
+	void draw_bitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t color,
+		uint16_t bg, bool transparent);
+	// clip the run of bsize pixels from (x, y) to the right (or down if vertical) by the screen,
+	// returns false if nothing is left
+	bool clip_run(int16_t& x, int16_t& y, uint8_t& hbyte, uint16_t& bsize, bool vertical = false);
+	// direction of the screen line, going to the right (or down if vertical) through
+	// the buffer point (x, y): 0 - right, 1 - down, 2 - left, 3 - up.
+	// Returns the number of pixels the line goes in the same direction
+	// without leaving the buffer line or the panel row.
+	uint16_t line_run(int16_t x, int16_t y, uint8_t& dir, bool vertical = false);
+	// the screen shift to the right (or down if vertical) in the buffer terms,
+	// returns the shift along the buffer lines, or across them if across is set
+	int8_t buffer_shift(int8_t step, bool& across, bool vertical = false);
+	// bits of the byte in reverse order
+	static uint8_t reverse_bits(uint8_t b) {
+		b = (b >> 4) | (b << 4);
+		b = ((b & 0xCC) >> 2) | ((b & 0x33) << 2);
+		return ((b & 0xAA) >> 1) | ((b & 0x55) << 1);
+	}
 	virtual void getColorBytes(uint8_t* cbytes, uint16_t color) {};
 	virtual void  drawMarqueeString(int bX, int bY, const char* bChars, int length,
 		int16_t miny, int16_t maxy, byte orientation = 0);
@@ -390,6 +444,7 @@ protected:
 	uint8_t* matrixbuff[2];
 	volatile uint8_t backindex = 0;
 	volatile boolean swapflag = false;
+	volatile uint32_t frame_count = 0;
 	volatile uint8_t* front_buff;
 	uint16_t mem_Buffer_Size;
 	uint16_t x_len;
@@ -408,6 +463,14 @@ protected:
 	
 	bool use_shift = true;
 	bool fast_Hbyte = false;
+	// shiftScreen() works with any connect scheme
+	bool connect_shift = false;
+	// transforms of the panels for CONNECT_TILEMAP: by the screen position - the panel in the buffer,
+	// then by the panel in the buffer - the screen position, both with the rotation
+	struct DMD_Tile_Transform {
+		uint8_t panel;
+		uint8_t rotation;
+	}* tile_table = NULL;
 
 	//Pointer to current font
 	DMD_Font* Font;
@@ -430,6 +493,16 @@ protected:
 	void set_graph_mode(uint8_t gm = GRAPHICS_NORMAL) {
 		graph_mode = gm;
 	}
+	DMD_RasterOp get_raster_op(uint8_t gm) {
+		switch (gm) {
+		case GRAPHICS_INVERSE: return { 0xFFFF, 0xFFFF, 0, 0xFFFF, 0 };   // copy of inverted source
+		case GRAPHICS_TOGGLE:  return { 0, 0, 0, 0, 0xFFFF };             // XOR
+		case GRAPHICS_OR:      return { 0, 0, 0xFFFF, 0, 0 };
+		case GRAPHICS_AND:     return { 0, 0xFFFF, 0, 0, 0 };
+		case GRAPHICS_NOR:     return { 0xFFFF, 0, 0, 0, 0 };             // clear source pixels
+		default:               return { 0xFFFF, 0xFFFF, 0xFFFF, 0, 0 };   // copy
+		}
+	}
 	
 	
 	/*--------------------------------------------------------------------------------------*/
@@ -34,28 +34,29 @@ void register_running_dmd(DMD_MonoChrome_SPI* dmd, uint16_t scan_int)
 	running_dmds[spi_num - 1] = dmd;
 }
 /*--------------------------------------------------------------------------------------*/
+// Every tick stops the shared timers once, starts the row DMA on all registered
+// SPI buses back to back and restarts the timers. Each display switches the mux
+// and latches the row from the DMA completion callback of its own bus.
 void inline __attribute__((always_inline)) scan_running_dmds()
 {
-	static volatile uint8_t i = 0;
-    
 	if (!running_dmd_len) return;
 
-	
-	DMD_MonoChrome_SPI* next = NULL;
-
-	// search next valid DMD instance (for multi-SPI configuration)
-	while (!next) {
-		next = (DMD_MonoChrome_SPI*)running_dmds[i % DMD_SPI_CNT];
-		i++;
-	}
-
-	if (next) {
+	DMD_MonoChrome_SPI* first = NULL;
+	for (uint8_t i = 0; i < DMD_SPI_CNT; i++) {
+		DMD_MonoChrome_SPI* next = (DMD_MonoChrome_SPI*)running_dmds[i];
+		if (next) {
+			if (!first) {
+				first = next;
+				first->pauseRowTimers();
+			}
 #if defined( DMD_USE_DMA )
-		next->scanDisplayByDMA();
+			next->scanDisplayByDMA();
 #else
-		next->scanDisplayBySPI();
+			next->scanDisplayBySPI();
 #endif
+		}
 	}
+	first->resumeRowTimers();
 }
 /*--------------------------------------------------------------------------------------*/
 #if defined(__STM32F1__) 
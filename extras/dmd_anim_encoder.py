@@ -0,0 +1,296 @@
+#!/usr/bin/env python3
+"""
+ This file is a part of the DMD_STM32 library
+
+ Encoder of animations for DMD_RGB_Animation player.
+
+ Reads a folder of PPM images (P3 or P6, sorted by file name), converts every
+ image to the matrix buffer of DMD_RGB_BASE and writes a C header with
+ RLE-compressed key frames and XOR delta frames. See DMD_RGB_Animation.h
+ for the data format.
+
+ Only plain panel templates (RGBxxplainSxx) are supported, the parameters
+ must be the same as in the sketch:
+
+   DMD_RGB<RGB64x32plainS16, COLOR_4BITS> dmd(..., DISPLAYS_ACROSS, DISPLAYS_DOWN, ...)
+
+   python3 dmd_anim_encoder.py frames/ -o logo_anim.h --name logo_anim \\
+       --panel 64x32 --scan 16 --panels 1x1 --depth 4 --delay 10 --loop
+
+ --depth 4 - COLOR_4BITS, 3 - COLOR_4BITS_Packed, 1 - COLOR_1BITS
+ --delay   - frame duration in screen refresh cycles
+ --key N   - force key frame every N frames (default - only if delta is larger)
+ --verify  - decode the result and compare it with the source frames
+"""
+import argparse
+import os
+import sys
+
+VERSION = 1
+KEY_FRAME = 0
+DELTA_FRAME = 1
+LOOP_DELTA = 0x01
+
+
+class Matrix:
+    """ Layout of the DMD_RGB_BASE matrix buffer """
+
+    def __init__(self, panel_w, panel_h, scan, across, down, depth):
+        self.panel_h = panel_h
+        self.width = panel_w * across
+        self.height = panel_h * down
+        self.down = down
+        self.scan = scan
+        self.depth = depth
+        self.pol_displ = panel_h // 2
+        self.multiplex = self.pol_displ // scan
+        self.x_len = self.width * self.multiplex * down
+        self.displ_len = self.width * self.pol_displ * down
+        self.size = self.width * self.height * depth // 2
+        if depth == 3:
+            self.masks = ((0x07, 0x47, 0xC7), (0xF8, 0xB8, 0x38))
+        else:
+            self.masks = ((0x07,) * depth, (0x38,) * depth)
+
+    # DMD_RGB_BASE::get_base_addr()
+    def base_addr(self, x, y):
+        if self.multiplex == 1:
+            return (y % self.pol_displ) * self.width * self.down + (y // self.panel_h) * self.width + x
+        pol_y = y % self.pol_displ
+        x += (y // self.panel_h) * self.width
+        return ((pol_y % self.scan) * self.x_len + (x // 8) * self.multiplex * 8 +
+                (pol_y // self.scan) * 8 + x % 8)
+
+    # getColorBytes() for 8-bit RGB, through Color888()
+    def color_bytes(self, r, g, b):
+        r >>= 4
+        g >>= 4
+        b >>= 4
+        cb = [0] * self.depth
+        if self.depth == 3:
+            if r & 1:
+                cb[1] |= 0x80
+                cb[2] |= 0x40
+            if g & 1:
+                cb[0] |= 0x40
+                cb[2] |= 0x80
+            if b & 1:
+                cb[0] |= 0x80
+                cb[1] |= 0x40
+            planes = range(1, 4)
+        else:
+            planes = range(self.depth)
+        for i, p in enumerate(planes):
+            bit = 1 << p
+            if r & bit:
+                cb[i] |= 0x09
+            if g & bit:
+                cb[i] |= 0x12
+            if b & bit:
+                cb[i] |= 0x24
+        return cb
+
+    def render(self, pixels):
+        buf = bytearray(self.size)
+        for y in range(self.height):
+            mask = self.masks[1 if (y % self.panel_h) >= self.pol_displ else 0]
+            for x in range(self.width):
+                addr = self.base_addr(x, y)
+                cb = self.color_bytes(*pixels[y * self.width + x])
+                for i in range(self.depth):
+                    a = addr + i * self.displ_len
+                    buf[a] = (buf[a] & ~mask[i] & 0xFF) | (cb[i] & mask[i])
+        return buf
+
+
+def read_ppm(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+    tokens = []
+    pos = 0
+    # magic, width, height, maxval - comments are allowed between them
+    while len(tokens) < 4:
+        while data[pos:pos + 1].isspace():
+            pos += 1
+        if data[pos:pos + 1] == b'#':
+            while data[pos:pos + 1] not in (b'\n', b''):
+                pos += 1
+            continue
+        start = pos
+        while not data[pos:pos + 1].isspace():
+            pos += 1
+        tokens.append(data[start:pos])
+    magic, w, h, maxval = tokens[0], int(tokens[1]), int(tokens[2]), int(tokens[3])
+    if magic == b'P6':
+        raw = data[pos + 1:pos + 1 + w * h * 3]
+        values = list(raw)
+    elif magic == b'P3':
+        values = [int(v) for v in data[pos:].split()[:w * h * 3]]
+    else:
+        raise ValueError('%s: only P3 and P6 PPM files are supported' % path)
+    if maxval != 255:
+        values = [v * 255 // maxval for v in values]
+    pixels = [tuple(values[i:i + 3]) for i in range(0, w * h * 3, 3)]
+    return w, h, pixels
+
+
+def rle(buf):
+    """ RLE codes of DMD_RGB_Animation::show_record() """
+    out = bytearray()
+    lit = bytearray()
+
+    def flush():
+        while lit:
+            chunk = lit[:128]
+            out.append(len(chunk) - 1)
+            out.extend(chunk)
+            del lit[:128]
+
+    i = 0
+    n = len(buf)
+    while i < n:
+        j = i
+        while j < n and buf[j] == buf[i]:
+            j += 1
+        run = j - i
+        if buf[i] == 0 and run >= 3:
+            flush()
+            while run > 0:
+                k = min(run, 0x4000)
+                out.append(0xC0 | ((k - 1) >> 8))
+                out.append((k - 1) & 0xFF)
+                run -= k
+        elif run >= 3:
+            flush()
+            while run > 0:
+                k = min(run, 64)
+                out.append(0x80 | (k - 1))
+                out.append(buf[i])
+                run -= k
+        else:
+            lit.extend(buf[i:j])
+        i = j
+    flush()
+    return out
+
+
+def unrle(data, buf, delta):
+    i = 0
+    pos = 0
+    while i < len(data):
+        code = data[i]
+        i += 1
+        if code < 0x80:
+            for _ in range(code + 1):
+                buf[pos] = (buf[pos] ^ data[i]) if delta else data[i]
+                pos += 1
+                i += 1
+        elif code < 0xC0:
+            val = data[i]
+            i += 1
+            for _ in range((code & 0x3F) + 1):
+                buf[pos] = (buf[pos] ^ val) if delta else val
+                pos += 1
+        else:
+            n = (((code & 0x3F) << 8) | data[i]) + 1
+            i += 1
+            if not delta:
+                buf[pos:pos + n] = bytes(n)
+            pos += n
+
+
+def record(ftype, duration, payload):
+    return (bytes((ftype, 0)) + duration.to_bytes(2, 'little') +
+            len(payload).to_bytes(4, 'little') + payload)
+
+
+def encode(matrix, frames, delay, key_every, loop):
+    out = bytearray(b'DMA' + bytes((VERSION,)))
+    out += matrix.width.to_bytes(2, 'little') + matrix.height.to_bytes(2, 'little')
+    out += matrix.size.to_bytes(4, 'little')
+    out += bytes((matrix.depth, LOOP_DELTA if loop else 0))
+    out += len(frames).to_bytes(2, 'little')
+    prev = None
+    for n, buf in enumerate(frames):
+        key = rle(buf)
+        if prev is not None and not (key_every and n % key_every == 0):
+            delta = rle(bytes(a ^ b for a, b in zip(buf, prev)))
+            if len(delta) < len(key):
+                out += record(DELTA_FRAME, delay, delta)
+                prev = buf
+                continue
+        out += record(KEY_FRAME, delay, key)
+        prev = buf
+    if loop:
+        out += record(DELTA_FRAME, delay, rle(bytes(a ^ b for a, b in zip(frames[0], prev))))
+    return out
+
+
+def verify(data, frames, size):
+    buf = bytearray(size)
+    pos = 16
+    count = int.from_bytes(data[14:16], 'little')
+    expected = list(frames)
+    if data[13] & LOOP_DELTA:
+        count += 1
+        expected.append(frames[0])
+    for n in range(count):
+        ftype = data[pos]
+        length = int.from_bytes(data[pos + 4:pos + 8], 'little')
+        unrle(data[pos + 8:pos + 8 + length], buf, ftype == DELTA_FRAME)
+        pos += 8 + length
+        if buf != expected[n]:
+            return n
+    return -1
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Encode PPM frames for DMD_RGB_Animation')
+    ap.add_argument('folder')
+    ap.add_argument('-o', '--output', required=True)
+    ap.add_argument('--name', default='dmd_anim')
+    ap.add_argument('--panel', default='64x32', help='panel size in pixels, WxH')
+    ap.add_argument('--scan', type=int, default=16)
+    ap.add_argument('--panels', default='1x1', help='DISPLAYS_ACROSS x DISPLAYS_DOWN')
+    ap.add_argument('--depth', type=int, default=4, choices=(1, 3, 4))
+    ap.add_argument('--delay', type=int, default=10)
+    ap.add_argument('--key', type=int, default=0)
+    ap.add_argument('--loop', action='store_true')
+    ap.add_argument('--verify', action='store_true')
+    args = ap.parse_args()
+
+    pw, ph = (int(v) for v in args.panel.lower().split('x'))
+    across, down = (int(v) for v in args.panels.lower().split('x'))
+    matrix = Matrix(pw, ph, args.scan, across, down, args.depth)
+
+    files = sorted(f for f in os.listdir(args.folder) if f.lower().endswith(('.ppm', '.pnm')))
+    if not files:
+        sys.exit('no PPM files in ' + args.folder)
+    frames = []
+    for name in files:
+        w, h, pixels = read_ppm(os.path.join(args.folder, name))
+        if (w, h) != (matrix.width, matrix.height):
+            sys.exit('%s: image is %dx%d, screen is %dx%d' % (name, w, h, matrix.width, matrix.height))
+        frames.append(bytes(matrix.render(pixels)))
+
+    data = encode(matrix, frames, args.delay, args.key, args.loop)
+
+    if args.verify:
+        bad = verify(data, frames, matrix.size)
+        if bad >= 0:
+            sys.exit('verify: frame %d differs' % bad)
+        print('verify: %d frames OK' % len(frames))
+
+    with open(args.output, 'w') as f:
+        f.write('// Generated by dmd_anim_encoder.py from %s\n' % os.path.basename(os.path.normpath(args.folder)))
+        f.write('// %d frames, screen %dx%d, panel %dx%d scan %d, color depth %d, %d bytes\n' %
+                (len(frames), matrix.width, matrix.height, pw, ph, args.scan, args.depth, len(data)))
+        f.write('const uint8_t %s[] = {\n' % args.name)
+        for i in range(0, len(data), 16):
+            f.write('\t' + ', '.join('0x%02X' % b for b in data[i:i + 16]) + ',\n')
+        f.write('};\n')
+    print('%s: %d frames, %d bytes (raw %d)' % (args.output, len(frames), len(data), matrix.size * len(frames)))
+
+
+if __name__ == '__main__':
+    main()
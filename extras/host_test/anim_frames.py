@@ -0,0 +1,37 @@
+#!/usr/bin/env python3
+"""Frames for the animation test: a random background with three moving
+rectangles, written as PPM files to be encoded by dmd_anim_encoder.py.
+The even frames are plain (P3) PPM and the odd ones binary (P6) with a comment.
+
+usage: anim_frames.py WIDTH HEIGHT FRAMES FOLDER
+"""
+import os
+import random
+import sys
+
+
+def main():
+    w, h, n, folder = int(sys.argv[1]), int(sys.argv[2]), int(sys.argv[3]), sys.argv[4]
+    os.makedirs(folder, exist_ok=True)
+    random.seed(w * h)
+    bg = [(random.randrange(256), random.randrange(256), random.randrange(256))
+          if random.random() < 0.3 else (0, 0, 0) for _ in range(w * h)]
+    for f in range(n):
+        px = list(bg)
+        for k in range(3):
+            x0 = (f * (k + 1) * 3) % w
+            y0 = (f * 2 + k * 5) % h
+            for y in range(y0, min(h, y0 + 6)):
+                for x in range(x0, min(w, x0 + 8)):
+                    px[y * w + x] = (255 * (k == 0), 255 * (k == 1), 200)
+        name = os.path.join(folder, 'f%03d.ppm' % f)
+        if f % 2:
+            with open(name, 'wb') as out:
+                out.write(b'P6\n# frame\n%d %d\n255\n' % (w, h) + bytes(v for p in px for v in p))
+        else:
+            with open(name, 'w') as out:
+                out.write('P3\n%d %d\n255\n' % (w, h) + ' '.join(str(v) for p in px for v in p) + '\n')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+"""Sample GIFs of the GIF player test and their expected frames.
+
+Writes gif/<name>.gif and gif/<name>.rgb, the screen after every frame
+as 8/8/8 RGB. The samples cover global and local palettes of 1-8 bits,
+transparency, all disposal methods, interlace, partial frames, comment and
+NETSCAPE extensions, and LZW streams with the full code table cleared by
+the encoder or left deferred.
+
+usage: gif_samples.py [FOLDER]
+"""
+import os
+import random
+import struct
+import sys
+
+
+def lzw(indexes, min_size, defer):
+    clear = 1 << min_size
+    table = {(i,): i for i in range(clear)}
+    size = min_size + 1
+    nxt = clear + 2
+    codes = [(clear, size)]
+    w = ()
+    for k in indexes:
+        wk = w + (k,)
+        if wk in table:
+            w = wk
+            continue
+        codes.append((table[w], size))
+        if nxt < 4096:
+            table[wk] = nxt
+            nxt += 1
+            if nxt - 1 == (1 << size) and size < 12:
+                size += 1
+        elif not defer:
+            codes.append((clear, size))
+            table = {(i,): i for i in range(clear)}
+            size = min_size + 1
+            nxt = clear + 2
+        w = (k,)
+    if w:
+        codes.append((table[w], size))
+    codes.append((clear + 1, size))
+    out = bytearray()
+    bits = n = 0
+    for c, s in codes:
+        bits |= c << n
+        n += s
+        while n >= 8:
+            out.append(bits & 255)
+            bits >>= 8
+            n -= 8
+    if n:
+        out.append(bits & 255)
+    return out
+
+
+def sub_blocks(data):
+    out = bytearray()
+    for i in range(0, len(data), 255):
+        out.append(len(data[i:i + 255]))
+        out += data[i:i + 255]
+    out.append(0)
+    return out
+
+
+def palette(bits):
+    return [tuple(random.randrange(256) for _ in range(3)) for _ in range(1 << bits)]
+
+
+def make_gif(w, h, global_bits, frames):
+    """frames: dicts of rect (x, y, w, h), local (palette bits or 0), disposal,
+    transparent, interlace, delay, pattern ('random' or 'stripes'), defer"""
+    gpal = palette(global_bits)
+    out = bytearray(b'GIF89a') + struct.pack('<HHBBB', w, h, 0x80 | (global_bits - 1), 0, 0)
+    for c in gpal:
+        out += bytes(c)
+    out += b'\x21\xff\x0bNETSCAPE2.0\x03\x01\x00\x00\x00'
+    out += b'\x21\xfe' + sub_blocks(b'DMD_STM32 test')
+    canvas = [[(0, 0, 0)] * w for _ in range(h)]
+    screens = []
+    for f in frames:
+        fx, fy, fw, fh = f.get('rect', (0, 0, w, h))
+        pal = palette(f['local']) if f.get('local') else gpal
+        n = len(pal)
+        disposal = f.get('disposal', 0)
+        trans = f.get('transparent')
+        if f.get('pattern') == 'stripes':
+            idx = [[(x // 3 + y) % n for x in range(fw)] for y in range(fh)]
+        else:
+            idx = [[random.randrange(n) for x in range(fw)] for y in range(fh)]
+        flags = (disposal << 2) | (1 if trans is not None else 0)
+        out += b'\x21\xf9\x04' + struct.pack('<BHB', flags, f.get('delay', 10), trans or 0) + b'\x00'
+        desc = (0x80 | (f['local'] - 1)) if f.get('local') else 0
+        if f.get('interlace'):
+            desc |= 0x40
+        out += b'\x2c' + struct.pack('<HHHHB', fx, fy, fw, fh, desc)
+        if f.get('local'):
+            for c in pal:
+                out += bytes(c)
+        rows = list(range(fh))
+        if f.get('interlace'):
+            rows = list(range(0, fh, 8)) + list(range(4, fh, 8)) + list(range(2, fh, 4)) + list(range(1, fh, 2))
+        min_size = max(2, (n - 1).bit_length())
+        out += bytes([min_size]) + sub_blocks(lzw([i for r in rows for i in idx[r]], min_size, f.get('defer', False)))
+
+        prev = [row[:] for row in canvas]
+        for y in range(fh):
+            for x in range(fw):
+                if idx[y][x] != trans:
+                    canvas[fy + y][fx + x] = pal[idx[y][x]]
+        screens.append([row[:] for row in canvas])
+        if disposal == 2:
+            for y in range(fh):
+                for x in range(fw):
+                    canvas[fy + y][fx + x] = (0, 0, 0)
+        elif disposal == 3:
+            canvas = prev
+    out += b'\x3b'
+    return out, screens
+
+
+SAMPLES = {
+    # partial frames with all disposal methods and transparency, global palette
+    'disposal': (40, 24, 4, [
+        dict(disposal=1, delay=0),
+        dict(rect=(5, 3, 20, 10), disposal=0, transparent=2, delay=1),
+        dict(rect=(12, 8, 25, 16), disposal=2, pattern='stripes', delay=5),
+        dict(rect=(0, 0, 17, 9), disposal=3, transparent=0, delay=20),
+        dict(rect=(30, 14, 10, 10), disposal=1),
+    ]),
+    # local palettes of other sizes and interlaced frames
+    'local': (33, 17, 1, [
+        dict(local=8, interlace=True),
+        dict(rect=(3, 2, 29, 15), local=2, interlace=True, transparent=1, pattern='stripes', disposal=2),
+        dict(rect=(1, 1, 1, 1), disposal=1),
+        dict(rect=(4, 0, 9, 17), local=3, interlace=True, disposal=3),
+    ]),
+    # more than 4096 codes: cleared by the encoder, then deferred clear
+    'lzw': (96, 48, 8, [
+        dict(),
+        dict(defer=True, transparent=7),
+    ]),
+}
+
+
+def main():
+    folder = sys.argv[1] if len(sys.argv) > 1 else os.path.join(os.path.dirname(os.path.abspath(__file__)), 'gif')
+    os.makedirs(folder, exist_ok=True)
+    for name, (w, h, global_bits, frames) in SAMPLES.items():
+        random.seed(name)
+        data, screens = make_gif(w, h, global_bits, frames)
+        with open(os.path.join(folder, name + '.gif'), 'wb') as f:
+            f.write(data)
+        with open(os.path.join(folder, name + '.rgb'), 'wb') as f:
+            for s in screens:
+                f.write(bytes(v for row in s for c in row for v in c))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,43 @@
+// Part of the Adafruit GFX library used by the host tests,
+// the lines and rectangles are drawn by pixels
+#pragma once
+#include "Arduino.h"
+#include "gfxfont.h"
+
+class Adafruit_GFX : public Print {
+public:
+	Adafruit_GFX(int16_t w, int16_t h);
+	virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+	virtual void startWrite(void);
+	virtual void writePixel(int16_t x, int16_t y, uint16_t color);
+	virtual void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+	virtual void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+	virtual void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+	virtual void writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+	virtual void endWrite(void);
+	virtual void setRotation(uint8_t r);
+	virtual void invertDisplay(bool i);
+	virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+	virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+	virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+	virtual void fillScreen(uint16_t color);
+	virtual void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+	virtual void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+	void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color);
+	void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color, uint16_t bg);
+	void drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[], int16_t w, int16_t h);
+	void setTextColor(uint16_t c);
+	void setTextColor(uint16_t c, uint16_t bg);
+	void charBounds(char c, int16_t* x, int16_t* y, int16_t* minx, int16_t* miny, int16_t* maxx, int16_t* maxy);
+	int16_t width(void) const;
+	int16_t height(void) const;
+	uint8_t getRotation(void) const;
+
+protected:
+	const int16_t WIDTH, HEIGHT;
+	int16_t _width, _height, cursor_x, cursor_y;
+	uint16_t textcolor, textbgcolor;
+	uint8_t textsize, rotation;
+	bool wrap, _cp437;
+	GFXfont* gfxFont;
+};
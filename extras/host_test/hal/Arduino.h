@@ -0,0 +1,165 @@
+// Simulated Arduino core and libmaple HAL of STM32F4 for the host tests.
+// Only the declarations used by the library are here, the registers are
+// plain memory and the timers, DMA and SPI functions do nothing.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+
+// as in libmaple, the library defines uint8_t etc. as these types
+typedef unsigned char uint8;
+typedef unsigned short uint16;
+typedef unsigned int uint32;
+typedef signed char int8;
+typedef short int16;
+typedef bool boolean;
+typedef void (*voidFuncPtr)(void);
+
+#define F_CPU 168000000ul
+#define HIGH 1
+#define LOW 0
+#define OUTPUT 1
+#define PWM 2
+#define MSBFIRST 1
+#define SPI_MODE0 0
+#define F(x) x
+
+#define B000001 1
+#define B000010 2
+#define B000100 4
+#define B000111 7
+#define B001000 8
+#define B001001 9
+#define B010000 16
+#define B010010 18
+#define B100000 32
+#define B100100 36
+#define B111000 56
+#define B00000111 7
+#define B00001001 9
+#define B00010010 18
+#define B00100100 36
+#define B00111000 56
+#define B01000000 64
+#define B01000111 71
+#define B10000000 128
+#define B10111000 184
+#define B11000000 192
+#define B11000111 199
+#define B11111000 248
+
+void pinMode(uint8 pin, uint8 mode);
+void digitalWrite(uint8 pin, uint8 val);
+uint8 digitalRead(uint8 pin);
+void delay(uint32 ms);
+void delayMicroseconds(uint32 us);
+uint32 millis();
+uint32 micros();
+void noInterrupts();
+void interrupts();
+volatile uint32* portSetRegister(uint8 pin);
+uint32 digitalPinToBitMask(uint8 pin);
+
+// called by delay(), the tests run the refresh of the display here
+extern voidFuncPtr hal_delay_hook;
+
+// timers
+struct timer_gen_reg_map {
+	volatile uint32 CR1, CR2, SMCR, DIER, SR, EGR, CCMR1, CCMR2, CCER, CNT, PSC, ARR, RCR, CCR1, CCR2, CCR3, CCR4, BDTR, DCR, DMAR;
+};
+typedef timer_gen_reg_map timer_adv_reg_map;
+struct timer_dev { union { timer_gen_reg_map* gen; timer_adv_reg_map* adv; } regs; };
+extern const timer_dev* TIMER1;
+extern const timer_dev* TIMER2;
+extern const timer_dev* TIMER3;
+extern const timer_dev* TIMER4;
+extern const timer_dev* TIMER5;
+extern timer_adv_reg_map* TIMER1_BASE;
+extern timer_gen_reg_map* TIMER2_BASE;
+extern timer_gen_reg_map* TIMER3_BASE;
+extern timer_gen_reg_map* TIMER4_BASE;
+struct timer_map_t { const timer_dev* dev; uint8 channel; };
+extern timer_map_t timer_map[];
+
+enum timer_oc_mode {
+	TIMER_OC_MODE_FROZEN, TIMER_OC_MODE_ACTIVE_ON_MATCH, TIMER_OC_MODE_INACTIVE_ON_MATCH,
+	TIMER_OC_MODE_TOGGLE, TIMER_OC_MODE_PWM_1 = 6, TIMER_OC_MODE_PWM_2
+};
+enum { TIMER_UPDATE_INTERRUPT, TIMER_CC1_INTERRUPT, TIMER_CC2_INTERRUPT, TIMER_CC3_INTERRUPT, TIMER_CC4_INTERRUPT };
+#define TIMER_SMCR_MSM 0x80
+#define TIMER_SMCR_TS_ITR0 0x00
+#define TIMER_SMCR_TS_ITR2 0x20
+#define TIMER_SMCR_TS_ITR3 0x30
+#define TIMER_SMCR_SMS_RESET 4
+#define TIMER_SMCR_SMS_GATED 5
+#define TIMER_CR2_MMS_COMPARE_OC1REF 0x40
+
+void timer_init(const timer_dev* dev);
+void timer_pause(const timer_dev* dev);
+void timer_resume(const timer_dev* dev);
+void timer_set_prescaler(const timer_dev* dev, uint16 psc);
+uint16 timer_get_prescaler(const timer_dev* dev);
+void timer_set_reload(const timer_dev* dev, uint16 arr);
+void timer_set_compare(const timer_dev* dev, uint8 channel, uint16 value);
+void timer_set_count(const timer_dev* dev, uint16 value);
+uint16 timer_get_count(const timer_dev* dev);
+void timer_generate_update(const timer_dev* dev);
+void timer_oc_set_mode(const timer_dev* dev, uint8 channel, timer_oc_mode mode, uint8 flags);
+void timer_cc_enable(const timer_dev* dev, uint8 channel);
+void timer_cc_set_pol(const timer_dev* dev, uint8 channel, uint8 pol);
+void timer_attach_interrupt(const timer_dev* dev, uint8 interrupt, voidFuncPtr handler);
+void timer_dma_enable_req(const timer_dev* dev, uint8 channel);
+void timer_dma_enable_upd_req(const timer_dev* dev);
+
+// DMA
+struct dma_stream_t { volatile uint32 CR, NDTR, PAR, M0AR, M1AR, FCR; };
+struct dma_reg_map { volatile uint32 LISR, HISR, LIFCR, HIFCR; dma_stream_t STREAM[8]; };
+struct dma_dev { dma_reg_map* regs; };
+extern const dma_dev* DMA1;
+extern const dma_dev* DMA2;
+enum dma_channel { DMA_CH0, DMA_CH1, DMA_CH2, DMA_CH3, DMA_CH4, DMA_CH5, DMA_CH6, DMA_CH7 };
+enum dma_stream { DMA_STREAM0, DMA_STREAM1, DMA_STREAM2, DMA_STREAM3, DMA_STREAM4, DMA_STREAM5, DMA_STREAM6, DMA_STREAM7 };
+enum dma_xfer_size { DMA_SIZE_8BITS, DMA_SIZE_16BITS, DMA_SIZE_32BITS };
+#define DMA_MINC_MODE 1
+#define DMA_FROM_MEM 2
+#define DMA_CIRC_MODE 4
+#define DMA_TRNS_CMPLT 8
+
+void dma_init(const dma_dev* dev);
+void dma_enable(const dma_dev* dev, dma_stream stream);
+void dma_disable(const dma_dev* dev, dma_stream stream);
+void dma_clear_isr_bits(const dma_dev* dev, dma_stream stream);
+void dma_setup_transfer(const dma_dev* dev, dma_stream stream, dma_channel channel, dma_xfer_size trx_size,
+	volatile void* peripheral_address, volatile void* memory_address0, volatile void* memory_address1, uint32 flags);
+void dma_set_num_transfers(const dma_dev* dev, dma_stream stream, uint16 num_transfers);
+void dma_set_mem_addr(const dma_dev* dev, dma_stream stream, volatile void* address);
+void dma_attach_interrupt(const dma_dev* dev, dma_stream stream, voidFuncPtr handler);
+
+// SPI
+struct spi_reg_map { volatile uint32 CR1, CR2, SR, DR; };
+struct spi_dev { spi_reg_map* regs; };
+extern spi_dev* SPI1;
+extern spi_dev* SPI2;
+extern spi_dev* SPI3;
+int spi_is_tx_empty(spi_dev* dev);
+int spi_is_busy(spi_dev* dev);
+void spi_tx_dma_disable(spi_dev* dev);
+
+class Print {
+public:
+	void begin(...);
+	void print(...);
+	void println(...);
+	void write(...);
+};
+extern Print Serial;
+extern Print Serial1;
+
+class Stream : public Print {
+public:
+	virtual int available() { return 0; }
+	virtual int read() { return -1; }
+	virtual size_t readBytes(uint8_t* buf, size_t len) { return 0; }
+	size_t readBytes(char* buf, size_t len) { return readBytes((uint8_t*)buf, len); }
+};
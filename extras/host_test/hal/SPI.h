@@ -0,0 +1,23 @@
+// Simulated SPI library of the STM32 core for the host tests
+#pragma once
+#include "Arduino.h"
+
+struct SPISettings { SPISettings(uint32 clock, uint8 order, uint8 mode) {} };
+
+class SPIClass {
+public:
+	SPIClass(int spi_num);
+	uint8 sckPin();
+	uint8 mosiPin();
+	spi_dev* dev();
+	void begin();
+	void setBitOrder(uint8 order);
+	void setDataMode(uint8 mode);
+	void beginTransaction(SPISettings settings);
+	void write(uint8 data);
+	void onTransmit(void (*callback)(uint32));
+	void dmaSend(const void* buf, uint16 len, bool minc);
+	void dmaSendAsync(const void* buf, uint16 len, bool minc);
+private:
+	int spi_num;
+};
@@ -0,0 +1,15 @@
+// Font structures of the Adafruit GFX library
+#pragma once
+#include <stdint.h>
+
+typedef struct {
+	uint16_t bitmapOffset;
+	uint8_t width, height, xAdvance;
+	int8_t xOffset, yOffset;
+} GFXglyph;
+
+typedef struct {
+	uint8_t* bitmap;
+	GFXglyph* glyph;
+	uint8_t first, last, yAdvance;
+} GFXfont;
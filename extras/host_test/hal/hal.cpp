@@ -0,0 +1,174 @@
+// Simulated HAL for the host tests, see Arduino.h
+#include "Arduino.h"
+#include "SPI.h"
+#include "Adafruit_GFX.h"
+
+voidFuncPtr hal_delay_hook = NULL;
+
+static volatile uint32 port_regs[64];
+
+void pinMode(uint8 pin, uint8 mode) {}
+void digitalWrite(uint8 pin, uint8 val) {}
+uint8 digitalRead(uint8 pin) { return 0; }
+void delay(uint32 ms) { if (hal_delay_hook) hal_delay_hook(); }
+void delayMicroseconds(uint32 us) {}
+uint32 millis() { return 0; }
+uint32 micros() { return 0; }
+void noInterrupts() {}
+void interrupts() {}
+volatile uint32* portSetRegister(uint8 pin) { return &port_regs[pin & 63]; }
+uint32 digitalPinToBitMask(uint8 pin) { return 1ul << (pin & 15); }
+
+// timers
+static timer_gen_reg_map timer_regs[5];
+static timer_dev timers[5] = { { { &timer_regs[0] } }, { { &timer_regs[1] } }, { { &timer_regs[2] } },
+	{ { &timer_regs[3] } }, { { &timer_regs[4] } } };
+const timer_dev* TIMER1 = &timers[0];
+const timer_dev* TIMER2 = &timers[1];
+const timer_dev* TIMER3 = &timers[2];
+const timer_dev* TIMER4 = &timers[3];
+const timer_dev* TIMER5 = &timers[4];
+timer_adv_reg_map* TIMER1_BASE = &timer_regs[0];
+timer_gen_reg_map* TIMER2_BASE = &timer_regs[1];
+timer_gen_reg_map* TIMER3_BASE = &timer_regs[2];
+timer_gen_reg_map* TIMER4_BASE = &timer_regs[3];
+timer_map_t timer_map[128];
+
+void timer_init(const timer_dev* dev) {}
+void timer_pause(const timer_dev* dev) {}
+void timer_resume(const timer_dev* dev) {}
+void timer_set_prescaler(const timer_dev* dev, uint16 psc) {}
+uint16 timer_get_prescaler(const timer_dev* dev) { return 0; }
+void timer_set_reload(const timer_dev* dev, uint16 arr) {}
+void timer_set_compare(const timer_dev* dev, uint8 channel, uint16 value) {}
+void timer_set_count(const timer_dev* dev, uint16 value) {}
+uint16 timer_get_count(const timer_dev* dev) { return 0; }
+void timer_generate_update(const timer_dev* dev) {}
+void timer_oc_set_mode(const timer_dev* dev, uint8 channel, timer_oc_mode mode, uint8 flags) {}
+void timer_cc_enable(const timer_dev* dev, uint8 channel) {}
+void timer_cc_set_pol(const timer_dev* dev, uint8 channel, uint8 pol) {}
+void timer_attach_interrupt(const timer_dev* dev, uint8 interrupt, voidFuncPtr handler) {}
+void timer_dma_enable_req(const timer_dev* dev, uint8 channel) {}
+void timer_dma_enable_upd_req(const timer_dev* dev) {}
+
+// DMA
+static dma_reg_map dma_regs[2];
+static dma_dev dmas[2] = { { &dma_regs[0] }, { &dma_regs[1] } };
+const dma_dev* DMA1 = &dmas[0];
+const dma_dev* DMA2 = &dmas[1];
+
+void dma_init(const dma_dev* dev) {}
+void dma_enable(const dma_dev* dev, dma_stream stream) {}
+void dma_disable(const dma_dev* dev, dma_stream stream) {}
+void dma_clear_isr_bits(const dma_dev* dev, dma_stream stream) {}
+void dma_setup_transfer(const dma_dev* dev, dma_stream stream, dma_channel channel, dma_xfer_size trx_size,
+	volatile void* peripheral_address, volatile void* memory_address0, volatile void* memory_address1, uint32 flags) {}
+void dma_set_num_transfers(const dma_dev* dev, dma_stream stream, uint16 num_transfers) {}
+void dma_set_mem_addr(const dma_dev* dev, dma_stream stream, volatile void* address) {}
+void dma_attach_interrupt(const dma_dev* dev, dma_stream stream, voidFuncPtr handler) {}
+
+// SPI
+static spi_reg_map spi_regs[3];
+static spi_dev spis[3] = { { &spi_regs[0] }, { &spi_regs[1] }, { &spi_regs[2] } };
+spi_dev* SPI1 = &spis[0];
+spi_dev* SPI2 = &spis[1];
+spi_dev* SPI3 = &spis[2];
+
+int spi_is_tx_empty(spi_dev* dev) { return 1; }
+int spi_is_busy(spi_dev* dev) { return 0; }
+void spi_tx_dma_disable(spi_dev* dev) {}
+
+SPIClass::SPIClass(int spi_num) : spi_num(spi_num) {}
+uint8 SPIClass::sckPin() { return 5; }
+uint8 SPIClass::mosiPin() { return 7; }
+spi_dev* SPIClass::dev() { return &spis[spi_num - 1]; }
+void SPIClass::begin() {}
+void SPIClass::setBitOrder(uint8 order) {}
+void SPIClass::setDataMode(uint8 mode) {}
+void SPIClass::beginTransaction(SPISettings settings) {}
+void SPIClass::write(uint8 data) {}
+void SPIClass::onTransmit(void (*callback)(uint32)) {}
+void SPIClass::dmaSend(const void* buf, uint16 len, bool minc) {}
+void SPIClass::dmaSendAsync(const void* buf, uint16 len, bool minc) {}
+
+void Print::begin(...) {}
+void Print::print(...) {}
+void Print::println(...) {}
+void Print::write(...) {}
+Print Serial, Serial1;
+
+// GFX
+Adafruit_GFX::Adafruit_GFX(int16_t w, int16_t h) : WIDTH(w), HEIGHT(h) {
+	_width = w;
+	_height = h;
+	cursor_x = cursor_y = 0;
+	textcolor = textbgcolor = 0xFFFF;
+	textsize = 1;
+	rotation = 0;
+	wrap = true;
+	_cp437 = false;
+	gfxFont = NULL;
+}
+void Adafruit_GFX::startWrite() {}
+void Adafruit_GFX::endWrite() {}
+void Adafruit_GFX::writePixel(int16_t x, int16_t y, uint16_t color) { drawPixel(x, y, color); }
+void Adafruit_GFX::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) { fillRect(x, y, w, h, color); }
+void Adafruit_GFX::writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) { drawFastVLine(x, y, h, color); }
+void Adafruit_GFX::writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) { drawFastHLine(x, y, w, color); }
+void Adafruit_GFX::writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) { drawLine(x0, y0, x1, y1, color); }
+void Adafruit_GFX::setRotation(uint8_t r) {
+	rotation = r & 3;
+	_width = (rotation & 1) ? HEIGHT : WIDTH;
+	_height = (rotation & 1) ? WIDTH : HEIGHT;
+}
+void Adafruit_GFX::invertDisplay(bool i) {}
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+	for (int16_t i = 0; i < h; i++) writePixel(x, y + i, color);
+}
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+	for (int16_t i = 0; i < w; i++) writePixel(x + i, y, color);
+}
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+	for (int16_t i = x; i < x + w; i++) writeFastVLine(i, y, h, color);
+}
+void Adafruit_GFX::fillScreen(uint16_t color) { fillRect(0, 0, _width, _height, color); }
+void Adafruit_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+	int16_t dx = abs(x1 - x0), dy = -abs(y1 - y0);
+	int16_t sx = (x0 < x1) ? 1 : -1, sy = (y0 < y1) ? 1 : -1;
+	int16_t err = dx + dy;
+	for (;;) {
+		writePixel(x0, y0, color);
+		if (x0 == x1 && y0 == y1) break;
+		int16_t e2 = 2 * err;
+		if (e2 >= dy) { err += dy; x0 += sx; }
+		if (e2 <= dx) { err += dx; y0 += sy; }
+	}
+}
+void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+	drawFastHLine(x, y, w, color);
+	drawFastHLine(x, y + h - 1, w, color);
+	drawFastVLine(x, y, h, color);
+	drawFastVLine(x + w - 1, y, h, color);
+}
+void Adafruit_GFX::drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color) {
+	int16_t bw = (w + 7) / 8;
+	for (int16_t j = 0; j < h; j++)
+		for (int16_t i = 0; i < w; i++)
+			if (bitmap[j * bw + i / 8] & (0x80 >> (i & 7))) writePixel(x + i, y + j, color);
+}
+void Adafruit_GFX::drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color, uint16_t bg) {
+	int16_t bw = (w + 7) / 8;
+	for (int16_t j = 0; j < h; j++)
+		for (int16_t i = 0; i < w; i++)
+			writePixel(x + i, y + j, (bitmap[j * bw + i / 8] & (0x80 >> (i & 7))) ? color : bg);
+}
+void Adafruit_GFX::drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[], int16_t w, int16_t h) {
+	for (int16_t j = 0; j < h; j++)
+		for (int16_t i = 0; i < w; i++) writePixel(x + i, y + j, bitmap[j * w + i]);
+}
+void Adafruit_GFX::setTextColor(uint16_t c) { textcolor = textbgcolor = c; }
+void Adafruit_GFX::setTextColor(uint16_t c, uint16_t bg) { textcolor = c; textbgcolor = bg; }
+void Adafruit_GFX::charBounds(char c, int16_t* x, int16_t* y, int16_t* minx, int16_t* miny, int16_t* maxx, int16_t* maxy) {}
+int16_t Adafruit_GFX::width() const { return _width; }
+int16_t Adafruit_GFX::height() const { return _height; }
+uint8_t Adafruit_GFX::getRotation() const { return rotation; }
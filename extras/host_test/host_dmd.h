@@ -0,0 +1,66 @@
+// Helpers of the host tests: access to the buffers of a display and
+// the refresh of the screen, that is done by the timer interrupt on the MCU
+#pragma once
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+#include "DMD_RGB.h"
+
+typedef std::vector<uint8_t> Buffer;
+
+static uint8_t host_mux_list[] = { 1, 2, 3, 4, 5 };
+static uint8_t host_rgb_pins[] = { 6, 0, 1, 2, 3, 4, 5 };
+
+// delay() of the HAL refreshes the attached display,
+// so swapBuffers() is done as on the MCU
+static std::function<void()> host_scan;
+static void host_delay() { if (host_scan) host_scan(); }
+
+template <class D>
+class HostDMD : public D {
+public:
+	HostDMD(byte panelsWide, byte panelsHigh, bool d_buf)
+		: D(host_mux_list, 8, 9, host_rgb_pins, panelsWide, panelsHigh, d_buf) {
+		this->init();
+		host_scan = [this]() { refresh(); };
+		hal_delay_hook = host_delay;
+	}
+	~HostDMD() { host_scan = nullptr; }
+
+	// one screen refresh by the scan of the display, swaps the buffers if requested
+	void refresh() {
+		uint32_t frame = this->getFrameCount();
+		for (uint32_t n = 0; n < 1000000ul && this->getFrameCount() == frame; n++) this->scan_dmd();
+	}
+	Buffer front() { return Buffer(this->matrixbuff[1 - this->backindex], this->matrixbuff[1 - this->backindex] + this->mem_Buffer_Size); }
+	Buffer back() { return Buffer(this->matrixbuff[this->backindex], this->matrixbuff[this->backindex] + this->mem_Buffer_Size); }
+	void set_back(const Buffer& b) { std::copy(b.begin(), b.end(), this->matrixbuff[this->backindex]); }
+
+	// the image of w * h pixels of 8/8/8 RGB drawn by drawPixel() on the cleared screen,
+	// the reference of the players; the back buffer is kept
+	Buffer draw_reference(const uint8_t* rgb, int16_t x0, int16_t y0, int16_t w, int16_t h) {
+		Buffer saved = back();
+		this->fillScreen(0);
+		for (int16_t y = 0; y < h; y++)
+			for (int16_t x = 0; x < w; x++, rgb += 3)
+				this->drawPixel(x0 + x, y0 + y, this->Color888(rgb[0], rgb[1], rgb[2]));
+		Buffer ref = back();
+		set_back(saved);
+		return ref;
+	}
+};
+
+static bool read_file(const std::string& name, Buffer& data) {
+	FILE* f = fopen(name.c_str(), "rb");
+	if (f == NULL) return false;
+	uint8_t chunk[4096];
+	size_t len;
+	data.clear();
+	while ((len = fread(chunk, 1, sizeof(chunk), f)) > 0) data.insert(data.end(), chunk, chunk + len);
+	fclose(f);
+	return true;
+}
+
+static int host_fails = 0;
+#define HOST_CHECK(cond, ...) do { if (!(cond)) { host_fails++; printf("FAIL %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); } } while (0)
@@ -0,0 +1,31 @@
+#!/bin/sh
+# Host-side tests of the RGB players, built by g++ against the simulated
+# STM32F4 HAL of hal/. Needs python3 for the test data.
+#
+# usage: extras/host_test/run_tests.sh [BUILD_FOLDER]
+set -e
+HERE=$(cd "$(dirname "$0")" && pwd)
+LIB="$HERE/../.."
+OUT=${1:-"$HERE/build"}
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:-"-std=gnu++17 -O1 -g -fsanitize=address,undefined -w"}
+mkdir -p "$OUT"
+
+build() {
+	$CXX $CXXFLAGS -D__STM32F4__ -DARDUINO=10800 -I"$HERE/hal" -I"$HERE" -I"$LIB" -I"$OUT" \
+		"$HERE/hal/hal.cpp" "$LIB"/*.cpp "$HERE/$1.cpp" -o "$OUT/$1"
+}
+
+# animation: frames encoded for three panel layouts
+python3 "$HERE/anim_frames.py" 64 32 12 "$OUT/A"
+python3 "$HERE/anim_frames.py" 64 32 8 "$OUT/B"
+python3 "$HERE/anim_frames.py" 96 32 8 "$OUT/C"
+python3 "$LIB/extras/dmd_anim_encoder.py" "$OUT/A" -o "$OUT/anim_A.h" --name anim_A --panel 64x32 --scan 16 --panels 1x1 --depth 4 --delay 3 --loop
+python3 "$LIB/extras/dmd_anim_encoder.py" "$OUT/B" -o "$OUT/anim_B.h" --name anim_B --panel 32x16 --scan 8 --panels 2x2 --depth 3 --delay 2 --key 3
+python3 "$LIB/extras/dmd_anim_encoder.py" "$OUT/C" -o "$OUT/anim_C.h" --name anim_C --panel 32x16 --scan 4 --panels 3x2 --depth 1 --delay 1 --loop
+build test_anim
+"$OUT/test_anim" "$OUT"
+
+# GIF: the samples of gif_samples.py
+build test_gif
+"$OUT/test_gif" "$HERE"/gif/*.gif
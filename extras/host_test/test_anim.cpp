@@ -0,0 +1,112 @@
+// Host test of DMD_RGB_Animation: the frames encoded by dmd_anim_encoder.py
+// are played and every shown buffer is compared with the source PPM image
+// drawn by drawPixel().
+//
+// usage: test_anim FRAMES_FOLDER (with the A, B and C folders of run_tests.sh)
+#include "host_dmd.h"
+#include "DMD_RGB_Animation.h"
+#include <cctype>
+#include "anim_A.h"
+#include "anim_B.h"
+#include "anim_C.h"
+
+// P3 or P6 image of 8 bits per color
+static bool read_ppm(const std::string& name, int16_t& w, int16_t& h, Buffer& rgb) {
+	Buffer data;
+	if (!read_file(name, data) || data.size() < 2 || data[0] != 'P') return false;
+	bool binary = (data[1] == '6');
+	size_t pos = 2;
+	auto next_int = [&]() {
+		int v = 0;
+		while (pos < data.size()) {
+			if (data[pos] == '#') while (pos < data.size() && data[pos] != '\n') pos++;
+			else if (isspace(data[pos])) pos++;
+			else break;
+		}
+		while (pos < data.size() && isdigit(data[pos])) v = v * 10 + (data[pos++] - '0');
+		return v;
+	};
+	w = next_int();
+	h = next_int();
+	if (next_int() != 255) return false;
+	rgb.resize(w * h * 3);
+	if (binary) {
+		pos++;
+		if (data.size() < pos + rgb.size()) return false;
+		std::copy(data.begin() + pos, data.begin() + pos + rgb.size(), rgb.begin());
+	}
+	else for (auto& c : rgb) c = next_int();
+	return true;
+}
+
+template <class D>
+static void play(HostDMD<D>& d, const char* name, const std::string& folder, const uint8_t* anim, bool loop) {
+
+	std::vector<Buffer> ref;
+	for (int n = 0;; n++) {
+		char file[16];
+		snprintf(file, sizeof(file), "/f%03d.ppm", n);
+		int16_t w, h;
+		Buffer rgb;
+		if (!read_ppm(folder + file, w, h, rgb)) break;
+		ref.push_back(d.draw_reference(rgb.data(), 0, 0, w, h));
+	}
+	int frames = ref.size();
+
+	DMD_RGB_Animation a(&d, anim);
+	HOST_CHECK(a.isValid(), "%s: not valid", name);
+	if (!a.isValid()) return;
+	HOST_CHECK(a.getFrames() == frames, "%s: %d frames of %d", name, a.getFrames(), frames);
+
+	d.fillScreen(0);
+	d.swapBuffers(true);
+	a.start(loop);
+	int expect = 0, shown = 0;
+	HOST_CHECK(d.front() == ref[0], "%s: first frame", name);
+	// three times through the frames if looped
+	for (uint32_t t = 0; t < 10000 && shown < 3 * frames; t++) {
+		if (a.update()) {
+			expect = (expect + 1) % frames;
+			shown++;
+			HOST_CHECK(a.getCurrentFrame() == expect, "%s: frame index %d, expected %d", name, a.getCurrentFrame(), expect);
+			HOST_CHECK(d.front() == ref[expect], "%s: frame %d (%d shown)", name, expect, shown);
+		}
+		else if (!a.isRunning()) break;
+		d.refresh();
+	}
+	if (loop) HOST_CHECK(shown == 3 * frames, "%s: %d frames shown", name, shown);
+	else HOST_CHECK(shown == frames - 1 && !a.isRunning(), "%s: %d frames shown once", name, shown);
+	printf("%s: %d frames, %d shown\n", name, frames, shown);
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		printf("usage: %s FRAMES_FOLDER\n", argv[0]);
+		return 2;
+	}
+	std::string dir(argv[1]);
+	{
+		HostDMD<DMD_RGB<RGB64x32plainS16, COLOR_4BITS>> d(1, 1, true);
+		play(d, "64x32 4 bits", dir + "/A", anim_A, true);
+	}
+	{
+		HostDMD<DMD_RGB<RGB64x32plainS16, COLOR_4BITS>> d(1, 1, false);
+		play(d, "64x32 4 bits, single buffer", dir + "/A", anim_A, false);
+	}
+	{
+		HostDMD<DMD_RGB<RGB32x16plainS8, COLOR_4BITS_Packed>> d(2, 2, true);
+		play(d, "32x16 packed 4 bits, 2x2 panels", dir + "/B", anim_B, true);
+	}
+	{
+		HostDMD<DMD_RGB<2, 32, 16, 4, 0, COLOR_1BITS>> d(3, 2, true);
+		play(d, "32x16 scan 4 1 bit, 3x2 panels", dir + "/C", anim_C, true);
+	}
+	{
+		// the data of other panels or color depth is refused
+		HostDMD<DMD_RGB<RGB32x16plainS8, COLOR_4BITS>> d(3, 2, true);
+		DMD_RGB_Animation a(&d, anim_C);
+		HOST_CHECK(!a.isValid(), "color depth mismatch not detected");
+	}
+	printf("%s\n", host_fails ? "FAILED" : "passed");
+	return host_fails != 0;
+}
@@ -0,0 +1,60 @@
+// Host test of DMD_RGB_GIF: the sample GIFs of gif_samples.py are played
+// twice at two positions on the screen and every shown buffer is compared
+// with the expected frame drawn by drawPixel().
+//
+// usage: test_gif SAMPLE.gif... (the expected frames are in SAMPLE.rgb)
+#include "host_dmd.h"
+#include "DMD_RGB_GIF.h"
+
+template <class D>
+static void play(HostDMD<D>& d, const std::string& name) {
+
+	Buffer gif_data, rgb;
+	if (!read_file(name, gif_data) || !read_file(name.substr(0, name.size() - 4) + ".rgb", rgb)) {
+		HOST_CHECK(false, "%s: no files", name.c_str());
+		return;
+	}
+	for (int pos = 0; pos < 2; pos++) {
+		int16_t x0 = pos ? -3 : 0, y0 = pos ? 5 : 0;
+		DMD_RGB_GIF gif(&d, gif_data.data(), gif_data.size());
+		HOST_CHECK(gif.isValid(), "%s: not valid", name.c_str());
+		if (!gif.isValid()) return;
+		uint16_t w = gif.getWidth(), h = gif.getHeight();
+		size_t frame_size = (size_t)w * h * 3;
+		int frames = rgb.size() / frame_size;
+
+		std::vector<Buffer> ref;
+		for (int n = 0; n < frames; n++) ref.push_back(d.draw_reference(&rgb[n * frame_size], x0, y0, w, h));
+
+		d.fillScreen(0);
+		gif.setPosition(x0, y0);
+		HOST_CHECK(gif.start(true), "%s: start", name.c_str());
+		uint32_t refreshes = 0;
+		for (int loop = 0; loop < 2; loop++) {
+			for (int n = 0; n < frames; n++) {
+				if (loop || n) {
+					// the delays are from 100 ms to 200 ms
+					uint32_t t;
+					for (t = 0; t < d.getFrameRate() && !gif.update(); t++) d.refresh();
+					HOST_CHECK(t > 0 && t < d.getFrameRate(), "%s: frame %d after %u refreshes", name.c_str(), n, t);
+					refreshes += t;
+				}
+				HOST_CHECK(gif.getCurrentFrame() == n, "%s: frame index %d, expected %d", name.c_str(), gif.getCurrentFrame(), n);
+				HOST_CHECK(d.front() == ref[n], "%s: frame %d loop %d position %d", name.c_str(), n, loop, pos);
+			}
+		}
+		gif.stop();
+		if (!pos) printf("%s: %dx%d, %d frames, %u refreshes at %u fps\n", name.c_str(), w, h, frames, refreshes, d.getFrameRate());
+	}
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		printf("usage: %s SAMPLE.gif...\n", argv[0]);
+		return 2;
+	}
+	HostDMD<DMD_RGB<RGB64x32plainS16, COLOR_4BITS>> d(2, 2, true);
+	for (int i = 1; i < argc; i++) play(d, argv[i]);
+	printf("%s\n", host_fails ? "FAILED" : "passed");
+	return host_fails != 0;
+}